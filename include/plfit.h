@@ -36,6 +36,7 @@ typedef enum {
     PLFIT_LINEAR_ONLY,
     PLFIT_STRATIFIED_SAMPLING,
     PLFIT_GSS_OR_LINEAR,
+    PLFIT_HIERARCHICAL_SAMPLING,
     PLFIT_DEFAULT_CONTINUOUS_METHOD = PLFIT_STRATIFIED_SAMPLING
 } plfit_continuous_method_t;
 
@@ -43,6 +44,7 @@ typedef enum {
     PLFIT_LBFGS,
     PLFIT_LINEAR_SCAN,
     PLFIT_PRETEND_CONTINUOUS,
+    PLFIT_NEWTON,
     PLFIT_DEFAULT_DISCRETE_METHOD = PLFIT_LBFGS
 } plfit_discrete_method_t;
 
@@ -59,6 +61,7 @@ typedef struct _plfit_result_t {
     double L;         /* log-likelihood of the sample */
     double D;         /* test statistic for the KS test */
     double p;         /* p-value of the KS test */
+    long int num_trials;  /* number of synthetic datasets used for the exact p-value */
 } plfit_result_t;
 
 /********** structure that holds the options of plfit **********/
@@ -69,6 +72,16 @@ typedef struct _plfit_continuous_options_t {
     plfit_p_value_method_t p_value_method;
     double p_value_precision;
     plfit_mt_rng_t* rng;
+    struct {
+        size_t keep;        /* number of strata refined on each level */
+        double tolerance;   /* largest allowed excess of D over the one of an
+                               exhaustive scan; zero gives the exhaustive result,
+                               INFINITY skips the check */
+    } hierarchical;
+    double p_value_threshold;   /* stop the exact p-value calculation once p is known
+                                   to be below or above this; zero disables */
+    const char* p_value_checkpoint;  /* file to save the progress of the exact p-value
+                                        calculation to and to resume it from */
 } plfit_continuous_options_t;
 
 typedef struct _plfit_discrete_options_t {
@@ -82,6 +95,10 @@ typedef struct _plfit_discrete_options_t {
     plfit_p_value_method_t p_value_method;
     double p_value_precision;
     plfit_mt_rng_t* rng;
+    double p_value_threshold;   /* stop the exact p-value calculation once p is known
+                                   to be below or above this; zero disables */
+    const char* p_value_checkpoint;  /* file to save the progress of the exact p-value
+                                        calculation to and to resume it from */
 } plfit_discrete_options_t;
 
 PLFIT_EXPORT int plfit_continuous_options_init(plfit_continuous_options_t* options);
@@ -90,6 +107,23 @@ PLFIT_EXPORT int plfit_discrete_options_init(plfit_discrete_options_t* options);
 PLFIT_EXPORT extern const plfit_continuous_options_t plfit_continuous_default_options;
 PLFIT_EXPORT extern const plfit_discrete_options_t plfit_discrete_default_options;
 
+/******** prepared datasets that can be fitted many times ******/
+
+/* The arrays marked as built on demand are filled in by the first function
+ * that needs them, so a dataset must not be used from several threads at
+ * once. Use a separate dataset for each thread instead. */
+
+typedef struct _plfit_dataset_t {
+    double* xs;       /* the data points, sorted in increasing order */
+    size_t n;         /* number of data points */
+    double* logs;     /* logarithms of the data points; built on demand */
+    double* logsums;  /* suffix sums of logs with a trailing zero; built on demand */
+    void* runs;       /* blocks of identical data points; built on demand */
+} plfit_dataset_t;
+
+PLFIT_EXPORT int plfit_dataset_init(plfit_dataset_t* dataset, const double* xs, size_t n);
+PLFIT_EXPORT void plfit_dataset_destroy(plfit_dataset_t* dataset);
+
 /********** continuous power law distribution fitting **********/
 
 PLFIT_EXPORT int plfit_log_likelihood_continuous(const double* xs, size_t n, double alpha,
@@ -99,6 +133,13 @@ PLFIT_EXPORT int plfit_estimate_alpha_continuous(const double* xs, size_t n, dou
 PLFIT_EXPORT int plfit_continuous(const double* xs, size_t n,
         const plfit_continuous_options_t* options, plfit_result_t* result);
 
+PLFIT_EXPORT int plfit_log_likelihood_continuous_dataset(plfit_dataset_t* dataset,
+        double alpha, double xmin, double* l);
+PLFIT_EXPORT int plfit_estimate_alpha_continuous_dataset(plfit_dataset_t* dataset,
+        double xmin, const plfit_continuous_options_t* options, plfit_result_t* result);
+PLFIT_EXPORT int plfit_continuous_dataset(plfit_dataset_t* dataset,
+        const plfit_continuous_options_t* options, plfit_result_t* result);
+
 /*********** discrete power law distribution fitting ***********/
 
 PLFIT_EXPORT int plfit_estimate_alpha_discrete(const double* xs, size_t n, double xmin,
@@ -107,6 +148,13 @@ PLFIT_EXPORT int plfit_log_likelihood_discrete(const double* xs, size_t n, doubl
 PLFIT_EXPORT int plfit_discrete(const double* xs, size_t n, const plfit_discrete_options_t* options,
         plfit_result_t* result);
 
+PLFIT_EXPORT int plfit_estimate_alpha_discrete_dataset(plfit_dataset_t* dataset,
+        double xmin, const plfit_discrete_options_t* options, plfit_result_t *result);
+PLFIT_EXPORT int plfit_log_likelihood_discrete_dataset(plfit_dataset_t* dataset,
+        double alpha, double xmin, double* l);
+PLFIT_EXPORT int plfit_discrete_dataset(plfit_dataset_t* dataset,
+        const plfit_discrete_options_t* options, plfit_result_t* result);
+
 /***** resampling routines to generate synthetic replicates ****/
 
 PLFIT_EXPORT int plfit_resample_continuous(const double* xs, size_t n, double alpha, double xmin,
@@ -123,6 +171,13 @@ PLFIT_EXPORT int plfit_calculate_p_value_discrete(const double* xs, size_t n,
         const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
         plfit_result_t *result);
 
+PLFIT_EXPORT int plfit_calculate_p_value_continuous_dataset(plfit_dataset_t* dataset,
+        const plfit_continuous_options_t* options, plfit_bool_t xmin_fixed,
+        plfit_result_t *result);
+PLFIT_EXPORT int plfit_calculate_p_value_discrete_dataset(plfit_dataset_t* dataset,
+        const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
+        plfit_result_t *result);
+
 /************* calculating descriptive statistics **************/
 
 PLFIT_EXPORT int plfit_moments(const double* data, size_t n, double* mean, double* variance,
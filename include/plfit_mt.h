@@ -63,6 +63,25 @@ PLFIT_EXPORT void plfit_mt_init(plfit_mt_rng_t* rng);
  */
 PLFIT_EXPORT void plfit_mt_init_from_rng(plfit_mt_rng_t* rng, plfit_mt_rng_t* seeder);
 
+/**
+ * \brief Initializes a Mersenne Twister random number generator to the start
+ *        of a numbered stream.
+ *
+ * The state of the generator is filled from a SplitMix64 sequence whose
+ * starting point is derived from the key and the stream index, so the
+ * generator only depends on these two numbers and not on the state of any
+ * other generator. This allows independent computations (e.g., the trials of
+ * a bootstrap) to get their own reproducible random numbers no matter in
+ * which order or on which thread they are executed.
+ *
+ * \param  rng     the random number generator to initialize
+ * \param  key     the key that identifies the family of streams; typically
+ *                 derived from the seed of the computation
+ * \param  stream  the index of the stream within the family
+ */
+PLFIT_EXPORT void plfit_mt_init_from_stream(plfit_mt_rng_t* rng, uint64_t key,
+        uint64_t stream);
+
 /**
  * \brief Returns the next 32-bit random number from the given Mersenne Twister
  * random number generator.
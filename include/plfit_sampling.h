@@ -26,14 +26,53 @@
 
 __BEGIN_DECLS
 
+/**
+ * State of a binomial sampler. It caches the setup of the BTPE algorithm for
+ * the last count and probability values it was used with, so repeated draws
+ * with the same parameters are cheap. Each thread should have its own.
+ */
+typedef struct {
+    double psave;                 /**< Probability of the cached setup */
+    int nsave;                    /**< Count of the cached setup */
+    int m;                        /**< Mode of the distribution */
+    double c, fm, npq, p1, p2, p3, p4, qn;
+    double xl, xll, xlr, xm, xr;
+} plfit_rbinom_state_t;
+
+/**
+ * \brief Initializes the state of a binomial sampler.
+ *
+ * The state does not own any memory, so it does not have to be destroyed.
+ *
+ * \param  state  the state to initialize
+ */
+PLFIT_EXPORT void plfit_rbinom_state_init(plfit_rbinom_state_t* state);
+
 /**
  * Draws a sample from a binomial distribution with the given count and
- * probability values.
+ * probability values, using and updating the setup cached in the given state.
  *
  * This function is borrowed from R; see the corresponding license in
  * \c rbinom.c. The return value is always an integer.
  *
- * The function is \em not thread-safe.
+ * The function is thread-safe as long as each thread uses its own state and
+ * random number generator.
+ *
+ * \param  state  the state of the sampler
+ * \param  n      the number of trials
+ * \param  p      the success probability of each trial
+ * \param  rng    the Mersenne Twister random number generator to use
+ * \return the value drawn from the given binomial distribution.
+ */
+PLFIT_EXPORT double plfit_rbinom_state_sample(plfit_rbinom_state_t* state, double n,
+        double p, plfit_mt_rng_t* rng);
+
+/**
+ * Draws a sample from a binomial distribution with the given count and
+ * probability values.
+ *
+ * This is a wrapper around \ref plfit_rbinom_state_sample() that uses a
+ * single, shared state; therefore, the function is \em not thread-safe.
  *
  * \param  n    the number of trials
  * \param  p    the success probability of each trial
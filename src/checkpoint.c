@@ -0,0 +1,140 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+/* checkpoint.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "plfit_error.h"
+#include "checkpoint.h"
+
+/* The first line of every checkpoint file, including the format version */
+#define CHECKPOINT_HEADER "plfit-p-value-checkpoint 1"
+
+/* Checkpoints are small text files with one field per line. Floating-point
+ * values are written in hexadecimal so that they are read back exactly. */
+
+int plfit_p_value_checkpoint_read(const char* path,
+        plfit_p_value_checkpoint_t* checkpoint, plfit_bool_t* found) {
+    char header[64];
+    uint64_t n, stream_key;
+    int xmin_fixed, stopped, num_fields;
+    FILE* f;
+
+    *found = 0;
+
+    f = fopen(path, "r");
+    if (f == NULL) {
+        if (errno == ENOENT) {
+            return PLFIT_SUCCESS;
+        }
+        PLFIT_ERROR("cannot open checkpoint file", PLFIT_FAILURE);
+    }
+
+    if (fgets(header, sizeof(header), f) == NULL ||
+            strncmp(header, CHECKPOINT_HEADER "\n", sizeof(header)) != 0) {
+        fclose(f);
+        PLFIT_ERROR("invalid checkpoint file header", PLFIT_FAILURE);
+    }
+
+    num_fields = fscanf(f,
+            " kind %c n %" SCNu64 " xmin %lf alpha %lf D %lf precision %lf"
+            " threshold %lf xmin_fixed %d stream_key %" SCNu64 " num_trials %ld"
+            " successes %ld num_checks %ld stopped %d",
+            &checkpoint->kind, &n, &checkpoint->xmin, &checkpoint->alpha,
+            &checkpoint->D, &checkpoint->precision, &checkpoint->threshold,
+            &xmin_fixed, &stream_key, &checkpoint->num_trials,
+            &checkpoint->successes, &checkpoint->num_checks, &stopped);
+    fclose(f);
+
+    if (num_fields != 13 || checkpoint->num_trials < 0 || checkpoint->successes < 0 ||
+            checkpoint->successes > checkpoint->num_trials || checkpoint->num_checks < 0) {
+        PLFIT_ERROR("invalid checkpoint file", PLFIT_FAILURE);
+    }
+
+    checkpoint->n = (size_t) n;
+    checkpoint->xmin_fixed = xmin_fixed != 0;
+    checkpoint->stream_key = stream_key;
+    checkpoint->stopped = stopped != 0;
+    *found = 1;
+
+    return PLFIT_SUCCESS;
+}
+
+int plfit_p_value_checkpoint_write(const char* path,
+        const plfit_p_value_checkpoint_t* checkpoint) {
+    char* temp_path;
+    FILE* f;
+    int failed;
+
+    temp_path = (char*)malloc(strlen(path) + 5);
+    if (temp_path == NULL) {
+        PLFIT_ERROR("cannot write checkpoint file", PLFIT_ENOMEM);
+    }
+    strcpy(temp_path, path);
+    strcat(temp_path, ".tmp");
+
+    f = fopen(temp_path, "w");
+    if (f == NULL) {
+        free(temp_path);
+        PLFIT_ERROR("cannot write checkpoint file", PLFIT_FAILURE);
+    }
+
+    fprintf(f, CHECKPOINT_HEADER "\n");
+    fprintf(f, "kind %c\n", checkpoint->kind);
+    fprintf(f, "n %" PRIu64 "\n", (uint64_t) checkpoint->n);
+    fprintf(f, "xmin %a\n", checkpoint->xmin);
+    fprintf(f, "alpha %a\n", checkpoint->alpha);
+    fprintf(f, "D %a\n", checkpoint->D);
+    fprintf(f, "precision %a\n", checkpoint->precision);
+    fprintf(f, "threshold %a\n", checkpoint->threshold);
+    fprintf(f, "xmin_fixed %d\n", checkpoint->xmin_fixed ? 1 : 0);
+    fprintf(f, "stream_key %" PRIu64 "\n", checkpoint->stream_key);
+    fprintf(f, "num_trials %ld\n", checkpoint->num_trials);
+    fprintf(f, "successes %ld\n", checkpoint->successes);
+    fprintf(f, "num_checks %ld\n", checkpoint->num_checks);
+    fprintf(f, "stopped %d\n", checkpoint->stopped ? 1 : 0);
+
+    failed = ferror(f);
+    failed = fclose(f) != 0 || failed;
+
+#ifdef _WIN32
+    /* rename() does not replace existing files on Windows */
+    if (!failed) {
+        remove(path);
+    }
+#endif
+    if (failed || rename(temp_path, path) != 0) {
+        remove(temp_path);
+        free(temp_path);
+        PLFIT_ERROR("cannot write checkpoint file", PLFIT_FAILURE);
+    }
+
+    free(temp_path);
+
+    return PLFIT_SUCCESS;
+}
+
+plfit_bool_t plfit_p_value_checkpoint_matches(const plfit_p_value_checkpoint_t* a,
+        const plfit_p_value_checkpoint_t* b) {
+    return a->kind == b->kind && a->n == b->n && a->xmin == b->xmin &&
+        a->alpha == b->alpha && a->D == b->D && a->precision == b->precision &&
+        a->threshold == b->threshold && a->xmin_fixed == b->xmin_fixed;
+}
@@ -0,0 +1,95 @@
+/* checkpoint.h
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "plfit_decls.h"
+#include "plfit.h"
+
+__BEGIN_DECLS
+
+/**
+ * Progress of an exact p-value calculation, together with the parameters
+ * that identify the calculation.
+ *
+ * Since every trial draws from its own random number stream, the key of the
+ * streams and the number of trials completed so far are enough to continue
+ * the calculation exactly where it was left off.
+ */
+typedef struct {
+    char kind;               /**< 'C' for continuous and 'D' for discrete fits */
+    size_t n;                /**< Number of data points */
+    double xmin;             /**< Fitted xmin */
+    double alpha;            /**< Fitted exponent */
+    double D;                /**< KS statistic of the fit */
+    double precision;        /**< Requested precision of the p-value */
+    double threshold;        /**< Threshold of the sequential stopping rule */
+    plfit_bool_t xmin_fixed; /**< Whether the synthetic fits keep xmin fixed */
+
+    uint64_t stream_key;     /**< Key of the random number streams of the trials */
+    long int num_trials;     /**< Number of trials completed so far */
+    long int successes;      /**< Number of trials with a larger KS statistic */
+    long int num_checks;     /**< Number of checks of the stopping rule so far */
+    plfit_bool_t stopped;    /**< Whether the stopping rule ended the calculation */
+} plfit_p_value_checkpoint_t;
+
+/**
+ * Reads a checkpoint from the given file.
+ *
+ * \param  path        the name of the file
+ * \param  checkpoint  the checkpoint is returned here
+ * \param  found       set to zero if the file does not exist and to one if
+ *                     the checkpoint was read successfully
+ *
+ * \return \c PLFIT_SUCCESS, or \c PLFIT_FAILURE if the file exists but is
+ *         not a valid checkpoint
+ */
+int plfit_p_value_checkpoint_read(const char* path,
+        plfit_p_value_checkpoint_t* checkpoint, plfit_bool_t* found);
+
+/**
+ * Writes a checkpoint to the given file.
+ *
+ * The checkpoint is written to a temporary file next to the target first,
+ * which then replaces the target, so an interrupted write never leaves a
+ * truncated checkpoint behind.
+ *
+ * \param  path        the name of the file
+ * \param  checkpoint  the checkpoint to write
+ *
+ * \return \c PLFIT_SUCCESS, \c PLFIT_ENOMEM or \c PLFIT_FAILURE if the file
+ *         cannot be written
+ */
+int plfit_p_value_checkpoint_write(const char* path,
+        const plfit_p_value_checkpoint_t* checkpoint);
+
+/**
+ * Returns whether two checkpoints belong to the same p-value calculation,
+ * i.e. whether the parameters that identify the calculation are equal.
+ * The progress of the calculations is not compared.
+ */
+plfit_bool_t plfit_p_value_checkpoint_matches(const plfit_p_value_checkpoint_t* a,
+        const plfit_p_value_checkpoint_t* b);
+
+__END_DECLS
+
+#endif /* __CHECKPOINT_H__ */
@@ -59,7 +59,9 @@
 #endif
 
 #include <math.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "hzeta.h"
 #include "plfit_error.h"
 
@@ -410,24 +412,348 @@ extern
 double hsl_sf_hzeta_deriv2(const double s, const double q) {
 	HSL_SF_EVAL_RESULT(hsl_sf_hzeta_deriv2_e(s,q,&result)); }
 
+#ifndef USE_LONG_DOUBLE_HZETA
+// The zed functions below cancel about 2\log_{2}(q) bits, so they are
+// evaluated in double-double arithmetic: a value is the unevaluated sum
+// hi+lo of two doubles with |lo| <= ulp(hi)/2, carrying about 106 bits.
+// Only IEEE double operations are involved, so the results are the same on
+// every platform whatever long double happens to be there, and the code
+// runs on the vector units instead of the x87 FPU.
+// [Dekker (1971); Hida, Li & Bailey, `Library for double-double and
+// quad-double arithmetic' (2007)]
+typedef struct {
+	double hi;
+	double lo;
+} hsl_dd;
+
 static inline
-double hsl_sf_hZeta0_zed(const double s, const double q) {
-#if 1
-	const long double ld_q=(long double)(q);
+hsl_dd hsl_dd_quick_two_sum(const double a, const double b) { // |a| >= |b|
+	hsl_dd r;
+	r.hi=a+b;
+	r.lo=b-(r.hi-a);
+	return (r); }
+
+static inline
+hsl_dd hsl_dd_two_sum(const double a, const double b) {
+	hsl_dd r;
+	double bb;
+	r.hi=a+b;
+	bb=r.hi-a;
+	r.lo=(a-(r.hi-bb))+(b-bb);
+	return (r); }
+
+static inline
+hsl_dd hsl_dd_two_prod(const double a, const double b) {
+	hsl_dd r;
+	r.hi=a*b;
+#ifdef FP_FAST_FMA
+	r.lo=fma(a,b,-r.hi);
+#else
+	{ // Veltkamp splitting; hzeta.c is compiled without FMA contraction
+		const double ta=134217729.0*a;
+		const double tb=134217729.0*b;
+		const double ahi=ta-(ta-a);
+		const double bhi=tb-(tb-b);
+		const double alo=a-ahi;
+		const double blo=b-bhi;
+		r.lo=((ahi*bhi-r.hi)+ahi*blo+alo*bhi)+alo*blo;
+		}
+#endif
+	return (r); }
+
+static inline
+hsl_dd hsl_dd_add(const hsl_dd a, const hsl_dd b) {
+	hsl_dd s=hsl_dd_two_sum(a.hi,b.hi);
+	const hsl_dd t=hsl_dd_two_sum(a.lo,b.lo);
+	s=hsl_dd_quick_two_sum(s.hi,s.lo+t.hi);
+	return (hsl_dd_quick_two_sum(s.hi,s.lo+t.lo)); }
+
+static inline
+hsl_dd hsl_dd_add_d(const hsl_dd a, const double b) {
+	const hsl_dd s=hsl_dd_two_sum(a.hi,b);
+	return (hsl_dd_quick_two_sum(s.hi,s.lo+a.lo)); }
+
+static inline
+hsl_dd hsl_dd_neg(const hsl_dd a) {
+	hsl_dd r;
+	r.hi=-a.hi;
+	r.lo=-a.lo;
+	return (r); }
+
+static inline
+hsl_dd hsl_dd_mul(const hsl_dd a, const hsl_dd b) {
+	const hsl_dd p=hsl_dd_two_prod(a.hi,b.hi);
+	return (hsl_dd_quick_two_sum(p.hi,p.lo+(a.hi*b.lo+a.lo*b.hi))); }
+
+static inline
+hsl_dd hsl_dd_mul_d(const hsl_dd a, const double b) {
+	const hsl_dd p=hsl_dd_two_prod(a.hi,b);
+	return (hsl_dd_quick_two_sum(p.hi,p.lo+a.lo*b)); }
+
+static inline
+hsl_dd hsl_dd_div(const hsl_dd a, const hsl_dd b) {
+	const double q1=a.hi/b.hi;
+	const hsl_dd r=hsl_dd_add(a,hsl_dd_neg(hsl_dd_mul_d(b,q1)));
+	const double q2=r.hi/b.hi;
+	const hsl_dd t=hsl_dd_add(r,hsl_dd_neg(hsl_dd_mul_d(b,q2)));
+	return (hsl_dd_add_d(hsl_dd_quick_two_sum(q1,q2),t.hi/b.hi)); }
+
+// 1/q with q a double
+static inline
+hsl_dd hsl_dd_inv_d(const double q) {
+	const double inv_q=1.0/q;
+	const hsl_dd p=hsl_dd_two_prod(inv_q,q);
+	return (hsl_dd_quick_two_sum(inv_q,((1.0-p.hi)-p.lo)/q)); }
+
+// 2^{j/64} for j = 0..63
+static const hsl_dd hsl_dd_exp2_table[64]={
+	{1.0000000000000000000e+00,0.0000000000000000000e+00},
+	{1.0108892860517004753e+00,-1.5234778603368577176e-17},
+	{1.0218971486541166271e+00,5.1092250289734438936e-17},
+	{1.0330248790212284149e+00,7.6008388740270884894e-18},
+	{1.0442737824274137548e+00,8.5518897055379648922e-17},
+	{1.0556451783605571570e+00,1.7593257387720919841e-18},
+	{1.0671404006768236972e+00,-7.8998539668415821223e-17},
+	{1.0787607977571198603e+00,-6.6566604360565926034e-17},
+	{1.0905077326652576897e+00,-3.0467820798124711470e-17},
+	{1.1023825833078408909e+00,5.2660368715706943866e-17},
+	{1.1143867425958924322e+00,1.0410278456845570955e-16},
+	{1.1265216186082418481e+00,5.1658567587954567370e-17},
+	{1.1387886347566915646e+00,8.9128126760254077778e-17},
+	{1.1511892299529826733e+00,3.2507102188638272120e-17},
+	{1.1637248587775774755e+00,3.8292048369240934987e-17},
+	{1.1763969916502812207e+00,5.5542032542180789628e-17},
+	{1.1892071150027210269e+00,3.9820152314656461110e-17},
+	{1.2021567314527030756e+00,6.6449814992523012449e-17},
+	{1.2152473599804689552e+00,-7.7126306926814881309e-17},
+	{1.2284805361068700247e+00,-1.8987816313025299531e-17},
+	{1.2418578120734840020e+00,4.6580275918369367912e-17},
+	{1.2553807570246910963e+00,-6.7113898212968784185e-18},
+	{1.2690509571917332199e+00,2.6679321313421860952e-18},
+	{1.2828700160787782636e+00,1.7135949182435609681e-17},
+	{1.2968395546510096406e+00,2.5382502794888314959e-17},
+	{1.3109612115247644137e+00,-7.1815361355194538570e-17},
+	{1.3252366431597413232e+00,-2.8587312100388613733e-17},
+	{1.3396675240533029161e+00,8.9272825948317319843e-17},
+	{1.3542555469368926513e+00,7.7009483798029894616e-17},
+	{1.3690024229745905160e+00,9.5937979191188487726e-17},
+	{1.3839098819638320226e+00,-6.7705116587947862872e-17},
+	{1.3989796725383112364e+00,-9.6142132090513230723e-17},
+	{1.4142135623730951455e+00,-9.6672933134529134511e-17},
+	{1.4296133383919700233e+00,-1.2031642489053655179e-17},
+	{1.4451808069770466503e+00,-3.0237581349939873194e-17},
+	{1.4609177941806470447e+00,-5.6003771860752158001e-17},
+	{1.4768261459394993462e+00,-3.4839945568927957958e-17},
+	{1.4929077282912648350e+00,1.4192920154284035771e-17},
+	{1.5091644275934228414e+00,-1.0164553277542950391e-16},
+	{1.5255981507445384171e+00,-1.1024941712342560936e-16},
+	{1.5422108254079407441e+00,7.9498348096976208562e-17},
+	{1.5590044002378369292e+00,3.7812070533575275019e-17},
+	{1.5759808451078864966e+00,-1.0136916471278303981e-17},
+	{1.5931421513422669989e+00,-1.0094406542311963722e-16},
+	{1.6104903319492542835e+00,2.4707192569797887852e-17},
+	{1.6280274218573478340e+00,-6.7129550847070840863e-17},
+	{1.6457554781539649458e+00,-1.0125679913674772604e-16},
+	{1.6636765803267363761e+00,5.8909926967130996705e-17},
+	{1.6817928305074290041e+00,8.1990100205814965201e-17},
+	{1.7001063537185234775e+00,-8.0237193703977002459e-18},
+	{1.7186192981224779341e+00,-1.8513804182631109882e-17},
+	{1.7373338352737062174e+00,3.1643892992929569466e-17},
+	{1.7562521603732994535e+00,2.9601406954488733070e-17},
+	{1.7753764925265211883e+00,6.4297317965565720340e-17},
+	{1.7947090750031071682e+00,1.8227458427912086770e-17},
+	{1.8142521755003988559e+00,-9.9695315389203488198e-17},
+	{1.8340080864093424307e+00,3.2831072242456272035e-17},
+	{1.8539791250833854708e+00,9.7618874907275935384e-17},
+	{1.8741676341102999626e+00,-6.1227634130041425616e-17},
+	{1.8945759815869656073e+00,3.4034035352165296706e-17},
+	{1.9152065613971474001e+00,-1.0619946056195962638e-16},
+	{1.9360617934922943473e+00,1.0332385960676325745e-16},
+	{1.9571441241754001794e+00,8.9607677910366677676e-17},
+	{1.9784560263879509279e+00,4.0388753109278166575e-17}
+	};
+
+// The kernels below work on HSL_DD_LANES independent arguments at a time:
+// every step is a short loop over the lanes, so that the compiler can map
+// the lanes onto the vector registers and the long dependency chains of
+// the double-double operations overlap.
+#define HSL_DD_LANES 4
+
+// expm1(r) where x = n\ln(2)/64 + r with |r| <= \ln(2)/128
+static inline
+void hsl_dd_expm1_reduced_lanes(const hsl_dd * x, hsl_dd * p, int * n) {
+	static const hsl_dd ln2_64={1.0830424696249145097e-02,3.6235106466348430600e-19};
+	static const hsl_dd c3={1.6666666666666665741e-01,9.2518585385429706566e-18};
+	static const hsl_dd c4={4.1666666666666664354e-02,2.3129646346357426642e-18};
+	static const hsl_dd c5={8.3333333333333332177e-03,1.1564823173178713802e-19};
+	static const hsl_dd c6={1.3888888888888889419e-03,-5.3005439543735770591e-20};
+	double dn[HSL_DD_LANES];
+	double t[HSL_DD_LANES];
+	hsl_dd r[HSL_DD_LANES];
+	int l;
+	for(l=0;l<HSL_DD_LANES;++l) {
+		// round to nearest without a call to the math library
+		dn[l]=(x[l].hi*(64.0*M_LOG2E)+6755399441055744.0)-6755399441055744.0;
+		r[l]=hsl_dd_add(x[l],hsl_dd_neg(hsl_dd_mul_d(ln2_64,dn[l])));
+		n[l]=(int)(dn[l]);
+		}
+	// from the 7th order on the Taylor terms are below 2^{-53}|r|,
+	// so they are summed in plain double
+	for(l=0;l<HSL_DD_LANES;++l) {
+		t[l]=2.5052108385441720224e-08;
+		t[l]=2.7557319223985888276e-07+r[l].hi*t[l];
+		t[l]=2.7557319223985892511e-06+r[l].hi*t[l];
+		t[l]=2.4801587301587301566e-05+r[l].hi*t[l];
+		t[l]=1.9841269841269841253e-04+r[l].hi*t[l];
+		}
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_add(c6,hsl_dd_mul_d(r[l],t[l]));
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_add(c5,hsl_dd_mul(r[l],p[l]));
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_add(c4,hsl_dd_mul(r[l],p[l]));
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_add(c3,hsl_dd_mul(r[l],p[l]));
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_add_d(hsl_dd_mul(r[l],p[l]),0.5);
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_add_d(hsl_dd_mul(r[l],p[l]),1.0);
+	for(l=0;l<HSL_DD_LANES;++l) p[l]=hsl_dd_mul(r[l],p[l]);
+	}
+
+// exp(x) from the output of hsl_dd_expm1_reduced_lanes
+static inline
+hsl_dd hsl_dd_exp_reconstruct(const hsl_dd p, const int n) {
+	const int j=n&63;
+	const double scale=ldexp(1.0,(n-j)/64);
+	const hsl_dd t=hsl_dd_exp2_table[j];
+	hsl_dd e=hsl_dd_add(t,hsl_dd_mul(t,p));
+	e.hi*=scale;
+	e.lo*=scale;
+	return (e); }
+
+static inline
+void hsl_dd_expm1_lanes(const hsl_dd * x, hsl_dd * y) {
+	int n[HSL_DD_LANES];
+	int l;
+	hsl_dd_expm1_reduced_lanes(x,y,n);
+	for(l=0;l<HSL_DD_LANES;++l) {
+		if (n[l]) y[l]=hsl_dd_add_d(hsl_dd_exp_reconstruct(y[l],n[l]),-1.0);
+		}
+	}
+
+// log(q) by one Newton step from the double precision logarithm:
+// y=y_{0}+q\exp(-y_{0})-1
+static inline
+void hsl_dd_log_lanes(const double * q, hsl_dd * y) {
+	double y0[HSL_DD_LANES];
+	hsl_dd e[HSL_DD_LANES];
+	int n[HSL_DD_LANES];
+	int l;
+	for(l=0;l<HSL_DD_LANES;++l) {
+		y0[l]=log(q[l]);
+		y[l].hi=-y0[l];
+		y[l].lo=0.0;
+		}
+	hsl_dd_expm1_reduced_lanes(y,e,n);
+	for(l=0;l<HSL_DD_LANES;++l) e[l]=hsl_dd_exp_reconstruct(e[l],n[l]);
+	for(l=0;l<HSL_DD_LANES;++l) y[l]=hsl_dd_add_d(hsl_dd_add_d(hsl_dd_mul_d(e[l],q[l]),-1.0),y0[l]);
+	}
+
+// log1p(1/q) by one Newton step from the double precision value:
+// y=y_{0}+\log1p((1/q-expm1(y_{0}))/(1+expm1(y_{0})))
+static inline
+void hsl_dd_log1prq_lanes(const double * q, hsl_dd * y) {
+	hsl_dd e[HSL_DD_LANES];
+	hsl_dd d[HSL_DD_LANES];
+	int l;
+	for(l=0;l<HSL_DD_LANES;++l) {
+		y[l].hi=log1p(1.0/q[l]);
+		y[l].lo=0.0;
+		}
+	hsl_dd_expm1_lanes(y,e);
+	for(l=0;l<HSL_DD_LANES;++l) d[l]=hsl_dd_add(hsl_dd_inv_d(q[l]),hsl_dd_neg(e[l]));
+	for(l=0;l<HSL_DD_LANES;++l) y[l]=hsl_dd_quick_two_sum(y[l].hi,d[l].hi/(1.0+e[l].hi));
+	}
+
+// q, q+1, ... into the lanes, incremented one by one as the summation loops
+// do; the lanes beyond n repeat the last argument
+static inline
+double hsl_dd_fill_lanes(double q, const size_t n, double * lanes) {
+	size_t l;
+	for(l=0;l<HSL_DD_LANES;++l) lanes[l]=(l<n)?q++:lanes[l-1];
+	return (q); }
+
+typedef hsl_dd hsl_sf_hZeta_log1prq_t;
+#else
+typedef long double hsl_sf_hZeta_log1prq_t;
+#endif
+
+// \log1p(1/q_j) in the extended precision of the zed functions
+// for q_j = q, q+1, ..., j = 0..n-1
+static
+void hsl_sf_hZeta0_zed_log1prq(double q, const size_t n, hsl_sf_hZeta_log1prq_t * log1prq) {
+	size_t j=0;
+#ifdef USE_LONG_DOUBLE_HZETA
+	for(j=0;j<n;++j) {
+		const long double ld_q=(long double)(q++);
+		log1prq[j]=log1pl(1.0L/ld_q);
+		}
+#else
+	double qs[HSL_DD_LANES];
+	hsl_dd y[HSL_DD_LANES];
+	size_t l=0;
+	for(j=0;j<n;j+=HSL_DD_LANES) {
+		q=hsl_dd_fill_lanes(q,n-j,qs);
+		hsl_dd_log1prq_lanes(qs,y);
+		for(l=0;(l<HSL_DD_LANES)&&(j+l<n);++l) log1prq[j+l]=y[l];
+		}
+#endif
+	}
+
+// zed_j = s + (q_j+s/2+1/2) expm1(-s\log1p(1/q_j)) for q_j = q, q+1, ..., j = 0..n-1
+static
+void hsl_sf_hZeta0_zed(const double s, double q, const size_t n, const hsl_sf_hZeta_log1prq_t * log1prq, double * zed) {
+	size_t j=0;
+#ifdef USE_LONG_DOUBLE_HZETA
 	const long double ld_s=(long double)(s);
-	const long double ld_log1prq=log1pl(1.0L/ld_q);
-	const long double ld_epsilon=expm1l(-ld_s*ld_log1prq);
-	const long double ld_z=ld_s+(ld_q+0.5L*ld_s+0.5L)*ld_epsilon;
-	const double z=(double)(ld_z);
+	for(j=0;j<n;++j) {
+		const long double ld_q=(long double)(q++);
+		const long double ld_epsilon=expm1l(-ld_s*log1prq[j]);
+		const long double ld_z=ld_s+(ld_q+0.5L*ld_s+0.5L)*ld_epsilon;
+		zed[j]=(double)(ld_z);
+		}
 #else
-	double z=s+(q+0.5*s+0.5)*expm1(-s*log1p(1.0/q));
+	double qs[HSL_DD_LANES];
+	hsl_dd x[HSL_DD_LANES];
+	hsl_dd epsilon[HSL_DD_LANES];
+	size_t l=0;
+	for(j=0;j<n;j+=HSL_DD_LANES) {
+		q=hsl_dd_fill_lanes(q,n-j,qs);
+		for(l=0;l<HSL_DD_LANES;++l) x[l]=hsl_dd_mul_d(log1prq[(j+l<n)?j+l:n-1],-s);
+		hsl_dd_expm1_lanes(x,epsilon);
+		for(l=0;l<HSL_DD_LANES;++l) x[l]=hsl_dd_add_d(hsl_dd_two_sum(qs[l],0.5*s),0.5);
+		for(l=0;l<HSL_DD_LANES;++l) x[l]=hsl_dd_add_d(hsl_dd_mul(x[l],epsilon[l]),s);
+		for(l=0;(l<HSL_DD_LANES)&&(j+l<n);++l) zed[j+l]=x[l].hi;
+		}
 #endif
-	return (z); }
+	}
+
+// q-dependent quantities of hsl_sf_hZeta0 that can be shared among several s:
+// log1p(j/q) and the log1p(1/(q+j)) of hsl_sf_hZeta0_zed for j = 0..shift
+typedef struct {
+	double log1p_jq[HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX+1];
+	hsl_sf_hZeta_log1prq_t log1prq[HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX+1];
+	size_t shift;
+} hsl_sf_hZeta0_cache;
+
+static
+void hsl_sf_hZeta0_cache_init(hsl_sf_hZeta0_cache * cache, const double q, const size_t shift) {
+	const double inv_q=1.0/q;
+	size_t j=0;
+	for(j=0;j<=shift;++j) cache->log1p_jq[j]=log1p(j*inv_q);
+	hsl_sf_hZeta0_zed_log1prq(q,shift+1,cache->log1prq);
+	cache->shift=shift; }
 
 // Z_{0}(s,a) = a^s \left(\frac{1}{2}+\frac{a}{s-1}\right)^{-1} \zeta(s,a) - 1
 // Z_{0}(s,a) = O\left(\frac{(s-1)s}{6a^{2}}\right)
+// cache may be NULL; otherwise it must cover the shift needed for s
 static
-int hsl_sf_hZeta0(const double s, const double q, double * value, double * abserror) {
+int hsl_sf_hZeta0(const double s, const double q, const hsl_sf_hZeta0_cache * cache, double * value, double * abserror) {
 	const double criterion=ceil(10.0*s-q);
 	const size_t shift=(criterion<0.0)?0:
 		(criterion<HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX)?(size_t)(llrint(criterion)):
@@ -453,11 +779,23 @@ int hsl_sf_hZeta0(const double s, const double q, double * value, double * abser
 		const double qphsm1=q+hsm1;
 		const double inv_qphsm1=1.0/qphsm1;
 		const double qshiftphsm1=qshift+hsm1;
-		double qs=q;
+		double zed[HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX];
 		double a=1.0;
-		for(j=0;j<shift;) {
-			ans+=(terms[n++]=a*hsl_sf_hZeta0_zed(s,qs++)*inv_qphsm1);
-			a=exp(-s*log1p((++j)*inv_q));
+		if (cache) {
+			hsl_sf_hZeta0_zed(s,q,shift,cache->log1prq,zed);
+			for(j=0;j<shift;) {
+				ans+=(terms[n++]=a*zed[j]*inv_qphsm1);
+				a=exp(-s*cache->log1p_jq[++j]);
+				}
+			}
+		else {
+			hsl_sf_hZeta_log1prq_t log1prq[HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX];
+			hsl_sf_hZeta0_zed_log1prq(q,shift,log1prq);
+			hsl_sf_hZeta0_zed(s,q,shift,log1prq,zed);
+			for(j=0;j<shift;) {
+				ans+=(terms[n++]=a*zed[j]*inv_qphsm1);
+				a=exp(-s*log1p((++j)*inv_q));
+				}
 			}
 		pcp*=a*qshiftphsm1*inv_qphsm1;
 		}
@@ -486,31 +824,57 @@ int hsl_sf_hZeta0(const double s, const double q, double * value, double * abser
 
 	return (PLFIT_SUCCESS); }
 
-static inline
-double hsl_sf_hZeta1_zed(const double s, const double q) {
-#if 1
-	const long double ld_q=(long double)(q);
+// the zed_j of Z_{1} for q_j = q, q+1, ..., j = 0..n-1
+static
+void hsl_sf_hZeta1_zed(const double s, double q, const size_t n, double * zed) {
+	size_t j=0;
+#ifdef USE_LONG_DOUBLE_HZETA
 	const long double ld_s=(long double)(s);
 	const long double ld_sm1=ld_s-1.0L;
-	const long double ld_logq=logl(ld_q);
-	const long double ld_log1prq=log1pl(1.0L/ld_q);
-	const long double ld_inv_logq=1.0L/ld_logq;
-	const long double ld_logratiom1=ld_log1prq*ld_inv_logq;
-	const long double ld_powratiom1=expm1l(-ld_s*ld_log1prq);
-	const long double ld_varepsilon=expm1l(-ld_sm1*ld_log1prq);
-	const long double ld_epsilon=ld_logratiom1+ld_powratiom1+ld_logratiom1*ld_powratiom1;
-	const long double ld_z=ld_s+(ld_q+0.5L*ld_s+0.5L)*ld_epsilon+ld_q/ld_sm1*ld_inv_logq*ld_varepsilon;
-	const double z=(double)(ld_z);
+	for(j=0;j<n;++j) {
+		const long double ld_q=(long double)(q++);
+		const long double ld_logq=logl(ld_q);
+		const long double ld_log1prq=log1pl(1.0L/ld_q);
+		const long double ld_inv_logq=1.0L/ld_logq;
+		const long double ld_logratiom1=ld_log1prq*ld_inv_logq;
+		const long double ld_powratiom1=expm1l(-ld_s*ld_log1prq);
+		const long double ld_varepsilon=expm1l(-ld_sm1*ld_log1prq);
+		const long double ld_epsilon=ld_logratiom1+ld_powratiom1+ld_logratiom1*ld_powratiom1;
+		const long double ld_z=ld_s+(ld_q+0.5L*ld_s+0.5L)*ld_epsilon+ld_q/ld_sm1*ld_inv_logq*ld_varepsilon;
+		zed[j]=(double)(ld_z);
+		}
 #else
-	const double sm1=s-1.0;
-	const double inv_ln_q=1.0/log(q);
-	const double log1prq=log1p(1.0/q);
-	const double logratiom1=log1prq*inv_ln_q;
-	const double powratiom1=expm1(-s*log1prq);
-	const double epsilon=logratiom1+powratiom1+logratiom1*powratiom1;
-	const double z=s+(q+0.5*s+0.5)*epsilon+q/sm1*inv_ln_q*expm1(-sm1*log1prq);
+	const hsl_dd dd_one={1.0,0.0};
+	const hsl_dd dd_sm1=hsl_dd_two_sum(s,-1.0);
+	double qs[HSL_DD_LANES];
+	hsl_dd log1prq[HSL_DD_LANES];
+	hsl_dd inv_logq[HSL_DD_LANES];
+	hsl_dd logratiom1[HSL_DD_LANES];
+	hsl_dd powratiom1[HSL_DD_LANES];
+	hsl_dd varepsilon[HSL_DD_LANES];
+	hsl_dd x[HSL_DD_LANES];
+	size_t l=0;
+	for(j=0;j<n;j+=HSL_DD_LANES) {
+		q=hsl_dd_fill_lanes(q,n-j,qs);
+		hsl_dd_log1prq_lanes(qs,log1prq);
+		hsl_dd_log_lanes(qs,x);
+		for(l=0;l<HSL_DD_LANES;++l) inv_logq[l]=hsl_dd_div(dd_one,x[l]);
+		for(l=0;l<HSL_DD_LANES;++l) logratiom1[l]=hsl_dd_mul(log1prq[l],inv_logq[l]);
+		for(l=0;l<HSL_DD_LANES;++l) x[l]=hsl_dd_mul_d(log1prq[l],-s);
+		hsl_dd_expm1_lanes(x,powratiom1);
+		for(l=0;l<HSL_DD_LANES;++l) x[l]=hsl_dd_neg(hsl_dd_mul(log1prq[l],dd_sm1));
+		hsl_dd_expm1_lanes(x,varepsilon);
+		for(l=0;l<HSL_DD_LANES;++l) {
+			const hsl_dd dd_q={qs[l],0.0};
+			const hsl_dd dd_epsilon=hsl_dd_add(hsl_dd_add(logratiom1[l],powratiom1[l]),hsl_dd_mul(logratiom1[l],powratiom1[l]));
+			const hsl_dd dd_a=hsl_dd_add_d(hsl_dd_two_sum(qs[l],0.5*s),0.5);
+			const hsl_dd dd_b=hsl_dd_mul(hsl_dd_div(dd_q,dd_sm1),hsl_dd_mul(inv_logq[l],varepsilon[l]));
+			x[l]=hsl_dd_add(hsl_dd_add_d(hsl_dd_mul(dd_a,dd_epsilon),s),dd_b);
+			}
+		for(l=0;(l<HSL_DD_LANES)&&(j+l<n);++l) zed[j+l]=x[l].hi;
+		}
 #endif
-	return (z); }
+	}
 
 // Z_{1}(s,a) = -\frac{a^s}{\ln(a)} \left(\frac{1}{2}+\frac{a}{s-1}\,\left[1+\frac{1}{(s-1)\,\ln(a)}\right]\right)^{-1} \zeta^{\prime}(s,a) - 1
 // Z_{1}(s,a) = O\left(\frac{(s-1)s}{6a^{2}}\right)
@@ -552,10 +916,13 @@ int hsl_sf_hZeta1(const double s, const double q, const double ln_q, double * va
 		const double qwphsm1=q*w+hsm1;
 		const double inv_qwphsm1=1.0/qwphsm1;
 		const double qshiftwshiftphsm1=qshift*wshift+hsm1;
+		double zed[HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX];
 		double qs=q;
 		double a=1.0;
+		hsl_sf_hZeta1_zed(s,q,shift,zed);
 		for(j=0;j<shift;) {
-			ans+=(terms[n++]=a*hsl_sf_hZeta1_zed(s,qs++)*inv_qwphsm1);
+			ans+=(terms[n++]=a*zed[j]*inv_qwphsm1);
+			++qs;
 			a=log(qs)*inv_ln_q*exp(-s*log1p((++j)*inv_q));
 			}
 		pcp*=a*qshiftwshiftphsm1*inv_qwphsm1;
@@ -587,12 +954,99 @@ int hsl_sf_hZeta1(const double s, const double q, const double ln_q, double * va
 
 	return (PLFIT_SUCCESS); }
 
-extern
-int hsl_sf_lnhzeta_deriv_tuple_e(const double s, const double q, gsl_sf_result * result, gsl_sf_result * result_deriv) {
+// Large q: the Euler-Maclaurin series of Z_{0} and Z_{1} without shift is an
+// asymptotic expansion in 1/q; its leading HSL_SF_LNHZETA_ASYMPTOTIC_ORDER
+// terms are used as they stand whenever the majorant of the remainder shows
+// them to be accurate to double precision
+#define HSL_SF_LNHZETA_ASYMPTOTIC_ORDER 4
+
+// returns 1 and Z_{0}(s,q) if the truncated expansion is certified, 0 otherwise
+static inline
+int hsl_sf_hZeta0_asymptotic(const double s, const double q, double * value, double * abserror) {
+	if (q < 10.0*s) return (0);
+	else {
+		const double inv_q=1.0/q;
+		const double sqr_inv_q=inv_q*inv_q;
+		const double sm1=s-1.0;
+		double terms[HSL_SF_LNHZETA_ASYMPTOTIC_ORDER];
+		double tscp=s;
+		double scp=s*sm1;
+		double pcp=inv_q/(2.0*q+sm1);
+		double ratio=scp*pcp;
+		size_t j=0;
+		double ans=0.0;
+		double mjr=NAN;
+		terms[0]=ratio/6.0;
+		scp*=++tscp;
+		scp*=++tscp;
+		pcp*=2.0*sqr_inv_q;
+		ratio=scp*pcp;
+		for(j=2;j<=HSL_SF_LNHZETA_ASYMPTOTIC_ORDER;++j) {
+			terms[j-1]=hsl_sf_hzeta_eulermaclaurin_series_coeffs[j]*ratio;
+			scp*=++tscp;
+			scp*=++tscp;
+			pcp*=sqr_inv_q;
+			ratio=scp*pcp;
+			}
+		j=HSL_SF_LNHZETA_ASYMPTOTIC_ORDER; while (j) ans+=terms[--j];
+		mjr=hsl_sf_hzeta_eulermaclaurin_series_majorantratios[HSL_SF_LNHZETA_ASYMPTOTIC_ORDER]*ratio;
+		if (!(mjr <= 0.5*GSL_DBL_EPSILON*fabs(ans))) return (0);
+		*value=ans;
+		*abserror=2.0*(GSL_DBL_EPSILON*fabs(ans)+mjr);
+		return (1);
+		}
+	}
+
+// returns 1 and Z_{1}(s,q) if the truncated expansion is certified, 0 otherwise
+static inline
+int hsl_sf_hZeta1_asymptotic(const double s, const double q, const double ln_q, double * value, double * abserror, double * coeff1) {
+	if (q < 10.0*s) return (0);
+	else {
+		const double inv_q=1.0/q;
+		const double inv_ln_q=1.0/ln_q;
+		const double sqr_inv_q=inv_q*inv_q;
+		const double sm1=s-1.0;
+		const double q_over_ln_q=q*inv_ln_q;
+		const double qphsm1=q+0.5*sm1;
+		double terms[HSL_SF_LNHZETA_ASYMPTOTIC_ORDER];
+		double tscp=s;
+		double scp=s*sm1;
+		double pcp=inv_q*sm1/(q_over_ln_q+sm1*qphsm1);
+		double lcp=1.0-inv_ln_q/s;
+		double ratio=scp*pcp*lcp;
+		size_t j=0;
+		double ans=0.0;
+		double mjr=NAN;
+		terms[0]=ratio/12.0;
+		scp*=++tscp; lcp-=inv_ln_q/tscp;
+		scp*=++tscp; lcp-=inv_ln_q/tscp;
+		pcp*=sqr_inv_q;
+		ratio=scp*pcp*lcp;
+		for(j=2;j<=HSL_SF_LNHZETA_ASYMPTOTIC_ORDER;++j) {
+			terms[j-1]=hsl_sf_hzeta_eulermaclaurin_series_coeffs[j]*ratio;
+			scp*=++tscp; lcp-=inv_ln_q/tscp;
+			scp*=++tscp; lcp-=inv_ln_q/tscp;
+			pcp*=sqr_inv_q;
+			ratio=scp*pcp*lcp;
+			}
+		j=HSL_SF_LNHZETA_ASYMPTOTIC_ORDER; while (j) ans+=terms[--j];
+		mjr=hsl_sf_hzeta_eulermaclaurin_series_majorantratios[HSL_SF_LNHZETA_ASYMPTOTIC_ORDER]*ratio;
+		if (!(mjr <= 0.5*GSL_DBL_EPSILON*fabs(ans))) return (0);
+		*value=ans;
+		*abserror=2.0*(GSL_DBL_EPSILON*fabs(ans)+mjr);
+		if (coeff1) *coeff1=1.0+q_over_ln_q/qphsm1/sm1;
+		return (1);
+		}
+	}
+
+static
+int hsl_sf_lnhzeta_deriv_tuple_ie(const double s, const double q, const int asymptotic, gsl_sf_result * result, gsl_sf_result * result_deriv) {
 
 	/* CHECK_POINTER(result) */
 
 	if ((s <= 1.0) || (q <= 0.0)) {
+		if (result) { result->val=NAN; result->err=NAN; }
+		if (result_deriv) { result_deriv->val=NAN; result_deriv->err=NAN; }
 		PLFIT_ERROR("s must be larger than 1.0 and q must be larger than zero", PLFIT_EINVAL);
 		}
 	else if (q == 1.0) {
@@ -602,7 +1056,7 @@ int hsl_sf_lnhzeta_deriv_tuple_e(const double s, const double q, gsl_sf_result *
 		const double hz_coeff1=1.0+inv_qsm1;
 		double hZeta0_value=NAN;
 		double hZeta0_abserror=NAN;
-		hsl_sf_hZeta0(s,2.0,&hZeta0_value,&hZeta0_abserror);
+		hsl_sf_hZeta0(s,2.0,NULL,&hZeta0_value,&hZeta0_abserror);
 		hZeta0_value+=1.0;
 		if (result) {
 			const double ln_hz_coeff=hz_coeff1/hz_coeff0;
@@ -629,7 +1083,9 @@ int hsl_sf_lnhzeta_deriv_tuple_e(const double s, const double q, gsl_sf_result *
 		const double ln_q=log(q);
 		double hZeta0_value=NAN;
 		double hZeta0_abserror=NAN;
-		hsl_sf_hZeta0(s,q,&hZeta0_value,&hZeta0_abserror);
+		if (!(asymptotic && hsl_sf_hZeta0_asymptotic(s,q,&hZeta0_value,&hZeta0_abserror))) {
+			hsl_sf_hZeta0(s,q,NULL,&hZeta0_value,&hZeta0_abserror);
+			}
 		if (result) {
 			const double ln_hz_term0=-s*ln_q;
 			const double ln_hz_term1=log(0.5+q/(s-1.0));
@@ -640,7 +1096,9 @@ int hsl_sf_lnhzeta_deriv_tuple_e(const double s, const double q, gsl_sf_result *
 			double hZeta1_value=NAN;
 			double hZeta1_abserror=NAN;
 			double ld_hz_coeff1=NAN;
-			hsl_sf_hZeta1(s,q,ln_q,&hZeta1_value,&hZeta1_abserror,&ld_hz_coeff1);
+			if (!(asymptotic && hsl_sf_hZeta1_asymptotic(s,q,ln_q,&hZeta1_value,&hZeta1_abserror,&ld_hz_coeff1))) {
+				hsl_sf_hZeta1(s,q,ln_q,&hZeta1_value,&hZeta1_abserror,&ld_hz_coeff1);
+				}
 			result_deriv->val=-ln_q*ld_hz_coeff1*(1.0+hZeta1_value)/(1.0+hZeta0_value);
 			result_deriv->err=2.0*GSL_DBL_EPSILON*fabs(result_deriv->val)+(hZeta0_abserror+hZeta1_abserror);
 			}
@@ -648,10 +1106,123 @@ int hsl_sf_lnhzeta_deriv_tuple_e(const double s, const double q, gsl_sf_result *
 
 	return (PLFIT_SUCCESS); }
 
+#ifdef USE_HZETA_CACHE
+// Bounded memo of hsl_sf_lnhzeta_deriv_tuple_e: a direct-mapped table per
+// thread, keyed on the exact bit patterns of (s,q), so a hit returns the
+// very same result as a fresh evaluation. The value and the derivative are
+// remembered separately; when only one of them is cached, the other one is
+// evaluated alone and the call counts as a miss
+#ifndef HSL_SF_LNHZETA_CACHE_SIZE
+#define HSL_SF_LNHZETA_CACHE_SIZE 512
+#endif
+#if (HSL_SF_LNHZETA_CACHE_SIZE < 1) || (HSL_SF_LNHZETA_CACHE_SIZE & (HSL_SF_LNHZETA_CACHE_SIZE - 1))
+#error "HSL_SF_LNHZETA_CACHE_SIZE must be a power of two"
+#endif
+
+#if defined(_MSC_VER)
+#define HSL_SF_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define HSL_SF_THREAD_LOCAL _Thread_local
+#else
+#define HSL_SF_THREAD_LOCAL __thread
+#endif
+
+#define HSL_SF_LNHZETA_CACHE_VALUE 1
+#define HSL_SF_LNHZETA_CACHE_DERIV 2
+
+typedef struct {
+	uint64_t s_bits;
+	uint64_t q_bits;
+	gsl_sf_result value;
+	gsl_sf_result deriv;
+	int flags; // which of value and deriv are valid; 0 for an empty slot
+} hsl_sf_lnhzeta_cache_entry;
+
+static HSL_SF_THREAD_LOCAL hsl_sf_lnhzeta_cache_entry hsl_sf_lnhzeta_cache[HSL_SF_LNHZETA_CACHE_SIZE];
+static HSL_SF_THREAD_LOCAL size_t hsl_sf_lnhzeta_cache_hits;
+static HSL_SF_THREAD_LOCAL size_t hsl_sf_lnhzeta_cache_misses;
+
+static inline
+hsl_sf_lnhzeta_cache_entry * hsl_sf_lnhzeta_cache_slot(const uint64_t s_bits, const uint64_t q_bits) {
+	uint64_t h=(s_bits^(q_bits*UINT64_C(0x9E3779B97F4A7C15)))*UINT64_C(0xBF58476D1CE4E5B9);
+	h^=h>>31;
+	return (hsl_sf_lnhzeta_cache+(size_t)(h&(HSL_SF_LNHZETA_CACHE_SIZE-1))); }
+#endif
+
+extern
+int hsl_sf_lnhzeta_deriv_tuple_e(const double s, const double q, gsl_sf_result * result, gsl_sf_result * result_deriv) {
+#ifdef USE_HZETA_CACHE
+	const int needed=((result)?HSL_SF_LNHZETA_CACHE_VALUE:0)|((result_deriv)?HSL_SF_LNHZETA_CACHE_DERIV:0);
+	uint64_t s_bits;
+	uint64_t q_bits;
+	hsl_sf_lnhzeta_cache_entry * entry=NULL;
+	gsl_sf_result value;
+	gsl_sf_result deriv;
+	int status=PLFIT_SUCCESS;
+	int missing;
+	memcpy(&s_bits,&s,sizeof(s_bits));
+	memcpy(&q_bits,&q,sizeof(q_bits));
+	entry=hsl_sf_lnhzeta_cache_slot(s_bits,q_bits);
+	if ((entry->s_bits != s_bits) || (entry->q_bits != q_bits)) {
+		entry->flags=0;
+		}
+	missing=needed&~entry->flags;
+	if (!missing) {
+		++hsl_sf_lnhzeta_cache_hits;
+		if (result) *result=entry->value;
+		if (result_deriv) *result_deriv=entry->deriv;
+		return (PLFIT_SUCCESS);
+		}
+	++hsl_sf_lnhzeta_cache_misses;
+	status=hsl_sf_lnhzeta_deriv_tuple_ie(s,q,1,
+		(missing&HSL_SF_LNHZETA_CACHE_VALUE)?&value:NULL,
+		(missing&HSL_SF_LNHZETA_CACHE_DERIV)?&deriv:NULL);
+	if (status) {
+		if (result) *result=value;
+		if (result_deriv) *result_deriv=deriv;
+		return (status);
+		}
+	entry->s_bits=s_bits;
+	entry->q_bits=q_bits;
+	if (missing&HSL_SF_LNHZETA_CACHE_VALUE) entry->value=value;
+	if (missing&HSL_SF_LNHZETA_CACHE_DERIV) entry->deriv=deriv;
+	entry->flags|=missing;
+	if (result) *result=entry->value;
+	if (result_deriv) *result_deriv=entry->deriv;
+	return (PLFIT_SUCCESS);
+#else
+	return (hsl_sf_lnhzeta_deriv_tuple_ie(s,q,1,result,result_deriv));
+#endif
+	}
+
+extern
+void hsl_sf_lnhzeta_cache_stats(size_t * hits, size_t * misses) {
+#ifdef USE_HZETA_CACHE
+	if (hits) *hits=hsl_sf_lnhzeta_cache_hits;
+	if (misses) *misses=hsl_sf_lnhzeta_cache_misses;
+#else
+	if (hits) *hits=0;
+	if (misses) *misses=0;
+#endif
+	}
+
+extern
+void hsl_sf_lnhzeta_cache_reset(void) {
+#ifdef USE_HZETA_CACHE
+	memset(hsl_sf_lnhzeta_cache,0,sizeof(hsl_sf_lnhzeta_cache));
+	hsl_sf_lnhzeta_cache_hits=0;
+	hsl_sf_lnhzeta_cache_misses=0;
+#endif
+	}
+
 extern
 double hsl_sf_lnhzeta_deriv_tuple(const double s, const double q, double * tuple0, double * tuple1) {
 	HSL_SF_EVAL_TUPLE_RESULT(hsl_sf_lnhzeta_deriv_tuple_e(s,q,&result0,&result1)); }
 
+extern
+double hsl_sf_lnhzeta_deriv_tuple_series(const double s, const double q, double * tuple0, double * tuple1) {
+	HSL_SF_EVAL_TUPLE_RESULT(hsl_sf_lnhzeta_deriv_tuple_ie(s,q,0,&result0,&result1)); }
+
 extern
 int hsl_sf_lnhzeta_e(const double s, const double q, gsl_sf_result * result) {
 	return (hsl_sf_lnhzeta_deriv_tuple_e(s,q,result,NULL)); }
@@ -668,5 +1239,167 @@ extern
 double hsl_sf_lnhzeta_deriv(const double s, const double q) {
 	HSL_SF_EVAL_RESULT(hsl_sf_lnhzeta_deriv_e(s,q,&result)); }
 
+// Logarithm of the Hurwitz zeta function for many q at once. For q >= 10s
+// hsl_sf_hZeta0 needs no shift, and its Euler-Maclaurin series reduces to
+//   Z_{0}(s,q) = p_{0} ( s(s-1)/6 + 2r \sum_{j>=2} c_{j} r^{j-2} )
+// with p_{0}=1/(q(2q+s-1)), r=1/q^2 and c_{j} = B_{2j}/(2j) (s-1)s(s+1)...(s+2j-2),
+// where the coefficients c_{j} depend on s only. They are computed once, the
+// polynomial is evaluated for HSL_SF_LNHZETA_BATCH_CHUNK values of q at a
+// time with the loop over q innermost so that it is vectorized, and the
+// number of terms is chosen for the smallest q of the batch, whose terms
+// decay the slowest. The remaining values of q take the scalar path.
+
+#define HSL_SF_LNHZETA_BATCH_CHUNK 64
+
+extern
+int hsl_sf_lnhzeta_batch(const double s, const double * q, const size_t n, double * out) {
+	double coeffs[HSL_SF_HZETA_EULERMACLAURIN_SERIES_ORDER+1]={NAN};
+	double r[HSL_SF_LNHZETA_BATCH_CHUNK];
+	double h[HSL_SF_LNHZETA_BATCH_CHUNK];
+	const double sm1=s-1.0;
+	const double inv_sm1=1.0/sm1;
+	double qmin=INFINITY;
+	double tscp=s;
+	double scp=s*sm1;
+	double rmax=NAN;
+	double ratio=NAN;
+	double delta=NAN;
+	double ans=NAN;
+	size_t order=0;
+	size_t i=0;
+	size_t k=0;
+	size_t m=0;
+	size_t j=0;
+
+	if (s <= 1.0) {
+		PLFIT_ERROR("s must be larger than 1.0 and q must be larger than zero", PLFIT_EINVAL);
+		}
+
+	for(i=0;i<n;++i) {
+		if (!(q[i] > 0.0)) {
+			PLFIT_ERROR("s must be larger than 1.0 and q must be larger than zero", PLFIT_EINVAL);
+			}
+		if ((ceil(10.0*s-q[i]) <= 0.0) && (q[i] < qmin)) qmin=q[i];
+		}
+
+	if (isfinite(qmin)) {
+		// the coefficients, and the number of terms that the scalar path
+		// would need for the smallest q
+		rmax=1.0/(qmin*qmin);
+		ans=scp/6.0;
+		ratio=2.0*rmax;
+		for(j=2;j<=HSL_SF_HZETA_EULERMACLAURIN_SERIES_ORDER;++j) {
+			scp*=++tscp;
+			scp*=++tscp;
+			coeffs[j]=hsl_sf_hzeta_eulermaclaurin_series_coeffs[j]*scp;
+			delta=coeffs[j]*ratio;
+			ans+=delta;
+			ratio*=rmax;
+			if ((fabs(delta/ans)) < (0.5*GSL_DBL_EPSILON)) break;
+			}
+		if (HSL_SF_HZETA_EULERMACLAURIN_SERIES_ORDER<j) PLFIT_ERROR("maximum iterations exceeded",PLFIT_EMAXITER);
+		order=j;
+		}
+
+	for(i=0;i<n;i+=m) {
+		m=(n-i<HSL_SF_LNHZETA_BATCH_CHUNK)?(n-i):HSL_SF_LNHZETA_BATCH_CHUNK;
+
+		if (order) {
+			for(k=0;k<m;++k) {
+				r[k]=1.0/(q[i+k]*q[i+k]);
+				h[k]=coeffs[order];
+				}
+			for(j=order;j>2;--j) {
+				const double c=coeffs[j-1];
+				for(k=0;k<m;++k) h[k]=h[k]*r[k]+c;
+				}
+			}
+
+		for(k=0;k<m;++k) {
+			const double qk=q[i+k];
+			if ((order) && (ceil(10.0*s-qk) <= 0.0)) {
+				const double p0=1.0/(qk*(2.0*qk+sm1));
+				const double hZeta0_value=p0*(s*sm1/6.0+2.0*r[k]*h[k]);
+				out[i+k]=-s*log(qk)+log(0.5+qk*inv_sm1)+log1p(hZeta0_value);
+				}
+			else {
+				gsl_sf_result result;
+				PLFIT_CHECK(hsl_sf_lnhzeta_e(s,qk,&result));
+				out[i+k]=result.val;
+				}
+			}
+		}
+
+	return (PLFIT_SUCCESS); }
+
+// Logarithm of the Hurwitz zeta function for many s and a single q. The head
+// of the series of hsl_sf_hZeta0 spends most of its time on log1p(j/q) and
+// log1pl(1/(q+j)), which do not depend on s; they are computed once for the
+// largest shift needed by any s and shared by all s, which are then evaluated
+// independently of each other (in parallel if OpenMP is enabled). The results
+// are identical to those of hsl_sf_lnhzeta.
+
+#define HSL_SF_LNHZETA_MULTI_PARALLEL_MIN 64
+
+static
+size_t hsl_sf_hZeta0_shift(const double s, const double q) {
+	const double criterion=ceil(10.0*s-q);
+	return ((criterion<0.0)?0:
+		(criterion<HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX)?(size_t)(llrint(criterion)):
+			HSL_SF_LNHZETA_EULERMACLAURIN_SERIES_SHIFT_MAX); }
+
+extern
+int hsl_sf_lnhzeta_multi(const double * s, const size_t n, const double q, double * out) {
+	hsl_sf_hZeta0_cache cache;
+	// hsl_sf_lnhzeta_deriv_tuple_e evaluates Z_{0} at 2 instead of 1
+	const double qz=(q==1.0)?2.0:q;
+	const double ln_q=log(q);
+	size_t shift=0;
+	ptrdiff_t i=0;
+	int retval=PLFIT_SUCCESS;
+
+	if (q <= 0.0) {
+		PLFIT_ERROR("s must be larger than 1.0 and q must be larger than zero", PLFIT_EINVAL);
+		}
+	for(i=0;i<(ptrdiff_t)(n);++i) {
+		if (!(s[i] > 1.0)) {
+			PLFIT_ERROR("s must be larger than 1.0 and q must be larger than zero", PLFIT_EINVAL);
+			}
+		if (shift < hsl_sf_hZeta0_shift(s[i],qz)) shift=hsl_sf_hZeta0_shift(s[i],qz);
+		}
+
+	hsl_sf_hZeta0_cache_init(&cache,qz,shift);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(n >= HSL_SF_LNHZETA_MULTI_PARALLEL_MIN)
+#endif
+	for(i=0;i<(ptrdiff_t)(n);++i) {
+		const double si=s[i];
+		double hZeta0_value=NAN;
+		double hZeta0_abserror=NAN;
+		if (!hsl_sf_hZeta0_asymptotic(si,qz,&hZeta0_value,&hZeta0_abserror) &&
+			hsl_sf_hZeta0(si,qz,&cache,&hZeta0_value,&hZeta0_abserror)) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+			retval=PLFIT_EMAXITER;
+			}
+		else if (q == 1.0) {
+			const double inv_sm1=1.0/(si-1.0);
+			const double inv_qsm1=4.0*inv_sm1;
+			const double hz_coeff0=exp2(si+1.0);
+			const double hz_coeff1=1.0+inv_qsm1;
+			const double ln_hz_coeff=hz_coeff1/hz_coeff0;
+			out[i]=log1p(ln_hz_coeff*(hZeta0_value+1.0));
+			}
+		else {
+			const double ln_hz_term0=-si*ln_q;
+			const double ln_hz_term1=log(0.5+q/(si-1.0));
+			out[i]=ln_hz_term0+ln_hz_term1+log1p(hZeta0_value);
+			}
+		}
+
+	return (retval); }
+
 //
 // End of file `hsl/specfunc/hzeta.c'.
@@ -32,6 +32,7 @@
 #ifndef __HZETA_H__
 #define __HZETA_H__
 
+#include <stddef.h>
 #include "plfit_decls.h"
 
 __BEGIN_DECLS
@@ -82,6 +83,51 @@ double hsl_sf_lnhzeta_deriv(const double s, const double q);
  */
 double hsl_sf_lnhzeta_deriv_tuple(const double s, const double q, double * deriv0, double * deriv1);
 
+/* Logarithm and Logarithmic Derivative of Hurwitz Zeta Function:
+ * series version:
+ * - same as hsl_sf_lnhzeta_deriv_tuple, but always sums the Euler-Maclaurin
+ *   series, whereas hsl_sf_lnhzeta_deriv_tuple switches over to a truncated
+ *   asymptotic expansion at large q once its error bound allows it;
+ * - meant for validation.
+ *
+ * s > 1.0, q > 0.0
+ */
+double hsl_sf_lnhzeta_deriv_tuple_series(const double s, const double q, double * deriv0, double * deriv1);
+
+/* Memoization of the Logarithm of Hurwitz Zeta Function and of its
+ * Logarithmic Derivative (builds with the PLFIT_USE_HZETA_CACHE option):
+ * - hsl_sf_lnhzeta, hsl_sf_lnhzeta_deriv and hsl_sf_lnhzeta_deriv_tuple look
+ *   their arguments up in a bounded table of each thread first, keyed on the
+ *   exact bit patterns of s and q, so the results are unaffected;
+ * - hsl_sf_lnhzeta_cache_stats returns the number of hits and misses of the
+ *   calling thread since its last hsl_sf_lnhzeta_cache_reset, which also
+ *   empties its table; both are zero when the cache is compiled out.
+ */
+void hsl_sf_lnhzeta_cache_stats(size_t * hits, size_t * misses);
+void hsl_sf_lnhzeta_cache_reset(void);
+
+/* Logarithm of Hurwitz Zeta Function for many q and a single s:
+ * out[i] = lnzeta(s,q[i]) for i = 0, 1, ..., n-1
+ * - the s-dependent coefficients of the Euler-Maclaurin series are shared
+ *   across all q, and the series is evaluated for several q at once;
+ * - the results agree with hsl_sf_lnhzeta within its error estimate;
+ * - returns PLFIT_SUCCESS or an error code.
+ *
+ * s > 1.0, q[i] > 0.0 (and q[i] >> 1)
+ */
+int hsl_sf_lnhzeta_batch(const double s, const double * q, const size_t n, double * out);
+
+/* Logarithm of Hurwitz Zeta Function for many s and a single q:
+ * out[i] = lnzeta(s[i],q) for i = 0, 1, ..., n-1
+ * - the q-dependent terms of the series are computed once and shared
+ *   across all s, which are evaluated in parallel if OpenMP is enabled;
+ * - the results are identical to those of hsl_sf_lnhzeta;
+ * - returns PLFIT_SUCCESS or an error code.
+ *
+ * s[i] > 1.0, q > 0.0 (and q >> 1)
+ */
+int hsl_sf_lnhzeta_multi(const double * s, const size_t n, const double q, double * out);
+
 
 __END_DECLS
 
@@ -0,0 +1,398 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+/* ks_kernel.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <float.h>
+#include <math.h>
+#include "ks_kernel.h"
+
+/* The vectorized kernels rely on GCC-style function attributes to compile
+ * AVX2 and AVX-512 code paths into an otherwise generic x86 binary, and on
+ * __builtin_cpu_supports() to pick one of them at runtime */
+#if defined(USE_AVX) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define PLFIT_KS_KERNEL_X86 1
+#  include <immintrin.h>
+#endif
+
+/* Clamping range for the argument of the vectorized exp(). Below the lower
+ * bound the result would be subnormal; it does not matter for the KS test
+ * because 1 - exp(x) rounds to 1 there anyway. */
+#define KS_EXP_MIN_ARG -708.0
+#define KS_EXP_MAX_ARG 709.0
+
+/* Block sizes of the block-bounded KS distance. Blocks are bisected until
+ * they are shorter than KS_BLOCK_MIN_SIZE; the bound of a block is relaxed
+ * by KS_BLOCK_SLACK to be on the safe side if exp() is not exactly monotone
+ * in the last bit. */
+#define KS_BLOCK_SIZE 128
+#define KS_BLOCK_MIN_SIZE 8
+#define KS_BLOCK_SLACK (8 * DBL_EPSILON)
+
+static double plfit_i_ks_distance_continuous_scalar(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff) {
+    double result = 0, d, dn = n;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        d = fabs(1 - exp(alpha_minus_1 * (log_xmin - log_xs[i])) - i / dn);
+        if (d > result) {
+            result = d;
+            if (result > cutoff)
+                break;
+        }
+    }
+
+    return result;
+}
+
+#ifdef PLFIT_KS_KERNEL_X86
+
+/* exp(x) is evaluated as 2^k * exp(r) where k = round(x / log(2)) and
+ * |r| <= log(2)/2. exp(r) is approximated with its Taylor polynomial of
+ * degree 13, whose truncation error is below 1e-17 on this interval. The
+ * coefficients below are 1/j! for j = 13, 12, ..., 0. */
+static const double ks_exp_coeffs[14] = {
+    1.6059043836821613e-10, 2.0876756987868099e-09, 2.5052108385441720e-08,
+    2.7557319223985893e-07, 2.7557319223985888e-06, 2.4801587301587302e-05,
+    1.9841269841269841e-04, 1.3888888888888889e-03, 8.3333333333333332e-03,
+    4.1666666666666664e-02, 1.6666666666666666e-01, 5.0000000000000000e-01,
+    1.0, 1.0
+};
+
+#define KS_LOG2E   1.4426950408889634
+#define KS_LN2_HI  6.93145751953125e-1
+#define KS_LN2_LO  1.42860682030941723212e-6
+/* Adding this to a small integer-valued double puts the integer in the low
+ * bits of the mantissa */
+#define KS_SHIFTER 4503599627370496.0   /* 2^52 */
+
+__attribute__((target("avx2,fma")))
+static __m256d plfit_i_exp_avx2(__m256d x) {
+    __m256d k, r, p;
+    __m256i bits;
+    int j;
+
+    /* min_pd and max_pd return their second operand if either one is NaN,
+     * so NaN arguments are passed through to the result */
+    x = _mm256_max_pd(_mm256_set1_pd(KS_EXP_MIN_ARG), x);
+    x = _mm256_min_pd(_mm256_set1_pd(KS_EXP_MAX_ARG), x);
+
+    k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(KS_LOG2E)),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(KS_LN2_HI), x);
+    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(KS_LN2_LO), r);
+
+    p = _mm256_set1_pd(ks_exp_coeffs[0]);
+    for (j = 1; j < 14; j++) {
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(ks_exp_coeffs[j]));
+    }
+
+    /* Construct 2^k directly in the exponent bits */
+    bits = _mm256_castpd_si256(_mm256_add_pd(k, _mm256_set1_pd(KS_SHIFTER + 1023.0)));
+    bits = _mm256_slli_epi64(bits, 52);
+
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+__attribute__((target("avx2,fma")))
+static double plfit_i_ks_distance_continuous_avx2(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff) {
+    const __m256d a = _mm256_set1_pd(alpha_minus_1);
+    const __m256d lxmin = _mm256_set1_pd(log_xmin);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d four = _mm256_set1_pd(4.0);
+    const __m256d dn = _mm256_set1_pd((double)n);
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d limit = _mm256_set1_pd(cutoff);
+    __m256d idx = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    __m256d acc = _mm256_setzero_pd();
+    __m256d e, d;
+    __m128d lo, hi;
+    double result, dn_scalar = n;
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        e = plfit_i_exp_avx2(_mm256_mul_pd(a, _mm256_sub_pd(lxmin, _mm256_loadu_pd(log_xs + i))));
+        d = _mm256_sub_pd(_mm256_sub_pd(one, e), _mm256_div_pd(idx, dn));
+        d = _mm256_andnot_pd(sign_mask, d);
+        /* max_pd returns its second operand if the first one is NaN, so
+         * NaNs are skipped just like in the scalar code */
+        acc = _mm256_max_pd(d, acc);
+        idx = _mm256_add_pd(idx, four);
+        if (_mm256_movemask_pd(_mm256_cmp_pd(acc, limit, _CMP_GT_OQ))) {
+            /* Early exit; skip the remaining elements as well */
+            i = n;
+            break;
+        }
+    }
+
+    /* Horizontal max-reduction */
+    lo = _mm256_castpd256_pd128(acc);
+    hi = _mm256_extractf128_pd(acc, 1);
+    lo = _mm_max_pd(lo, hi);
+    lo = _mm_max_pd(lo, _mm_unpackhi_pd(lo, lo));
+    result = _mm_cvtsd_f64(lo);
+
+    /* Remaining elements */
+    for (; i < n && result <= cutoff; i++) {
+        double dd = fabs(1 - exp(alpha_minus_1 * (log_xmin - log_xs[i])) - i / dn_scalar);
+        if (dd > result)
+            result = dd;
+    }
+
+    return result;
+}
+
+__attribute__((target("avx512f")))
+static __m512d plfit_i_exp_avx512(__m512d x) {
+    __m512d k, r, p;
+    __m512i bits;
+    int j;
+
+    /* Operand order as in plfit_i_exp_avx2() so that NaNs pass through */
+    x = _mm512_max_pd(_mm512_set1_pd(KS_EXP_MIN_ARG), x);
+    x = _mm512_min_pd(_mm512_set1_pd(KS_EXP_MAX_ARG), x);
+
+    k = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(KS_LOG2E)),
+            _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    r = _mm512_fnmadd_pd(k, _mm512_set1_pd(KS_LN2_HI), x);
+    r = _mm512_fnmadd_pd(k, _mm512_set1_pd(KS_LN2_LO), r);
+
+    p = _mm512_set1_pd(ks_exp_coeffs[0]);
+    for (j = 1; j < 14; j++) {
+        p = _mm512_fmadd_pd(p, r, _mm512_set1_pd(ks_exp_coeffs[j]));
+    }
+
+    bits = _mm512_castpd_si512(_mm512_add_pd(k, _mm512_set1_pd(KS_SHIFTER + 1023.0)));
+    bits = _mm512_slli_epi64(bits, 52);
+
+    return _mm512_mul_pd(p, _mm512_castsi512_pd(bits));
+}
+
+__attribute__((target("avx512f")))
+static double plfit_i_ks_distance_continuous_avx512(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff) {
+    const __m512d a = _mm512_set1_pd(alpha_minus_1);
+    const __m512d lxmin = _mm512_set1_pd(log_xmin);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d eight = _mm512_set1_pd(8.0);
+    const __m512d dn = _mm512_set1_pd((double)n);
+    const __m512d limit = _mm512_set1_pd(cutoff);
+    __m512d idx = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+    __m512d acc = _mm512_setzero_pd();
+    __m512d e, d;
+    __mmask8 mask;
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        e = plfit_i_exp_avx512(_mm512_mul_pd(a, _mm512_sub_pd(lxmin, _mm512_loadu_pd(log_xs + i))));
+        d = _mm512_abs_pd(_mm512_sub_pd(_mm512_sub_pd(one, e), _mm512_div_pd(idx, dn)));
+        acc = _mm512_max_pd(d, acc);
+        idx = _mm512_add_pd(idx, eight);
+        if (_mm512_cmp_pd_mask(acc, limit, _CMP_GT_OQ)) {
+            /* Early exit; skip the remaining elements as well */
+            return _mm512_reduce_max_pd(acc);
+        }
+    }
+
+    /* Remaining elements are handled with a masked iteration; inactive lanes
+     * leave the accumulator untouched */
+    if (i < n) {
+        mask = (__mmask8)((1u << (n - i)) - 1);
+        e = plfit_i_exp_avx512(_mm512_mul_pd(a, _mm512_sub_pd(lxmin,
+                        _mm512_mask_loadu_pd(lxmin, mask, log_xs + i))));
+        d = _mm512_abs_pd(_mm512_sub_pd(_mm512_sub_pd(one, e), _mm512_div_pd(idx, dn)));
+        acc = _mm512_mask_max_pd(acc, mask, d, acc);
+    }
+
+    return _mm512_reduce_max_pd(acc);
+}
+
+#endif /* PLFIT_KS_KERNEL_X86 */
+
+/* State of the block-bounded KS distance calculation */
+typedef struct {
+    const double* log_xs;
+    double alpha_minus_1;
+    double log_xmin;
+    double dn;
+    double cutoff;
+    double result;
+} plfit_i_ks_blocked_t;
+
+static double plfit_i_ks_blocked_cdf(const plfit_i_ks_blocked_t* state, size_t i) {
+    return 1 - exp(state->alpha_minus_1 * (state->log_xmin - state->log_xs[i]));
+}
+
+/* Updates the running maximum with the distance at index i, given the value
+ * of the CDF there. Returns nonzero if the cutoff was exceeded. */
+static int plfit_i_ks_blocked_update(plfit_i_ks_blocked_t* state, size_t i, double cdf) {
+    double d = fabs(cdf - i / state->dn);
+    if (d > state->result) {
+        state->result = d;
+        return state->result > state->cutoff;
+    }
+    return 0;
+}
+
+/* Finds the largest distance strictly between indices a and b, given the
+ * values of the CDF at a and b. Returns nonzero if the cutoff was exceeded. */
+static int plfit_i_ks_blocked_expand(plfit_i_ks_blocked_t* state, size_t a, size_t b,
+        double cdf_a, double cdf_b) {
+    double bound, lo, hi, cdf_mid;
+    size_t i, mid;
+
+    if (b - a < 2)
+        return 0;
+
+    /* Both CDFs are monotone, so the difference within the block is between
+     * the values below. These are calculated with the same floating-point
+     * operations as the distances themselves, and rounding is monotone, so
+     * the bound also holds for the computed distances. */
+    lo = fabs(cdf_a - b / state->dn);
+    hi = fabs(cdf_b - a / state->dn);
+    bound = lo > hi ? lo : hi;
+    if (bound + KS_BLOCK_SLACK <= state->result)
+        return 0;
+
+    if (b - a <= KS_BLOCK_MIN_SIZE) {
+        for (i = a + 1; i < b; i++) {
+            if (plfit_i_ks_blocked_update(state, i, plfit_i_ks_blocked_cdf(state, i)))
+                return 1;
+        }
+        return 0;
+    }
+
+    mid = a + (b - a) / 2;
+    cdf_mid = plfit_i_ks_blocked_cdf(state, mid);
+    return plfit_i_ks_blocked_update(state, mid, cdf_mid) ||
+        plfit_i_ks_blocked_expand(state, a, mid, cdf_a, cdf_mid) ||
+        plfit_i_ks_blocked_expand(state, mid, b, cdf_mid, cdf_b);
+}
+
+double plfit_ks_distance_continuous_blocked(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff) {
+    plfit_i_ks_blocked_t state;
+    double cdf_a, cdf_b;
+    size_t a, b;
+
+    if (n == 0)
+        return 0;
+
+    state.log_xs = log_xs;
+    state.alpha_minus_1 = alpha_minus_1;
+    state.log_xmin = log_xmin;
+    state.dn = n;
+    state.cutoff = cutoff;
+    state.result = 0;
+
+    /* Evaluate the endpoints of the blocks first to get a good lower bound
+     * for the maximum, then expand the blocks that may still exceed it */
+    for (a = 0; a < n; a += KS_BLOCK_SIZE) {
+        if (plfit_i_ks_blocked_update(&state, a, plfit_i_ks_blocked_cdf(&state, a)))
+            return state.result;
+    }
+    if (plfit_i_ks_blocked_update(&state, n - 1, plfit_i_ks_blocked_cdf(&state, n - 1)))
+        return state.result;
+
+    cdf_a = plfit_i_ks_blocked_cdf(&state, 0);
+    for (a = 0; a < n - 1; a = b) {
+        b = a + KS_BLOCK_SIZE < n - 1 ? a + KS_BLOCK_SIZE : n - 1;
+        cdf_b = plfit_i_ks_blocked_cdf(&state, b);
+        if (plfit_i_ks_blocked_expand(&state, a, b, cdf_a, cdf_b))
+            break;
+        cdf_a = cdf_b;
+    }
+
+    return state.result;
+}
+
+int plfit_ks_kernel_available(plfit_ks_kernel_t kernel) {
+    switch (kernel) {
+        case PLFIT_KS_KERNEL_SCALAR:
+            return 1;
+
+#ifdef PLFIT_KS_KERNEL_X86
+        case PLFIT_KS_KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+
+        case PLFIT_KS_KERNEL_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+
+        default:
+            return 0;
+    }
+}
+
+plfit_ks_kernel_t plfit_ks_kernel_best(void) {
+    if (plfit_ks_kernel_available(PLFIT_KS_KERNEL_AVX512))
+        return PLFIT_KS_KERNEL_AVX512;
+    if (plfit_ks_kernel_available(PLFIT_KS_KERNEL_AVX2))
+        return PLFIT_KS_KERNEL_AVX2;
+    return PLFIT_KS_KERNEL_SCALAR;
+}
+
+/* Signature of the KS distance kernels */
+typedef double plfit_i_ks_distance_func_t(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff);
+
+static plfit_i_ks_distance_func_t* plfit_i_ks_kernel_function(plfit_ks_kernel_t kernel) {
+    switch (kernel) {
+#ifdef PLFIT_KS_KERNEL_X86
+        case PLFIT_KS_KERNEL_AVX2:
+            return plfit_i_ks_distance_continuous_avx2;
+
+        case PLFIT_KS_KERNEL_AVX512:
+            return plfit_i_ks_distance_continuous_avx512;
+#endif
+
+        default:
+            return plfit_i_ks_distance_continuous_scalar;
+    }
+}
+
+double plfit_ks_distance_continuous_with_kernel(plfit_ks_kernel_t kernel,
+        const double* log_xs, size_t n, double alpha_minus_1, double log_xmin,
+        double cutoff) {
+    return plfit_i_ks_kernel_function(kernel)(log_xs, n, alpha_minus_1, log_xmin,
+            cutoff);
+}
+
+/* The best kernel. It is resolved once when the library is loaded, before
+ * any thread could call plfit_ks_distance_continuous(); the scalar kernel is
+ * the only one without the vectorized kernels. */
+static plfit_i_ks_distance_func_t* plfit_i_ks_distance_continuous_best =
+    plfit_i_ks_distance_continuous_scalar;
+
+#ifdef PLFIT_KS_KERNEL_X86
+__attribute__((constructor))
+static void plfit_i_ks_kernel_init(void) {
+    /* Constructors may run before the CPU features are detected */
+    __builtin_cpu_init();
+    plfit_i_ks_distance_continuous_best =
+        plfit_i_ks_kernel_function(plfit_ks_kernel_best());
+}
+#endif
+
+double plfit_ks_distance_continuous(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff) {
+    return plfit_i_ks_distance_continuous_best(log_xs, n, alpha_minus_1, log_xmin,
+            cutoff);
+}
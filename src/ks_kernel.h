@@ -0,0 +1,105 @@
+/* ks_kernel.h
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __KS_KERNEL_H__
+#define __KS_KERNEL_H__
+
+#include <stdlib.h>
+#include "plfit_decls.h"
+
+__BEGIN_DECLS
+
+/**
+ * Samples at least this long are better served by
+ * \ref plfit_ks_distance_continuous_blocked() than by the vectorized kernels.
+ */
+#define PLFIT_KS_BLOCKED_THRESHOLD 8192
+
+/**
+ * Enum listing the implementations of the KS distance kernels.
+ */
+typedef enum {
+    PLFIT_KS_KERNEL_SCALAR,      /**< Portable scalar implementation */
+    PLFIT_KS_KERNEL_AVX2,        /**< AVX2 + FMA implementation, four lanes */
+    PLFIT_KS_KERNEL_AVX512       /**< AVX-512F implementation, eight lanes */
+} plfit_ks_kernel_t;
+
+/**
+ * Returns whether the given kernel was compiled in and is supported by the
+ * CPU that we are running on.
+ */
+int plfit_ks_kernel_available(plfit_ks_kernel_t kernel);
+
+/**
+ * Returns the fastest kernel that is available on the current CPU.
+ */
+plfit_ks_kernel_t plfit_ks_kernel_best(void);
+
+/**
+ * Calculates the KS distance between the empirical CDF of a sorted sample
+ * and the CDF of a continuous power-law fitted to it.
+ *
+ * The sample is given in the log domain, and it must be cut off at xmin so
+ * the first element is always larger than or equal to log(xmin). The
+ * fitted CDF is evaluated as 1 - exp((alpha-1) * (log(xmin) - log(x))).
+ *
+ * The kernel is selected at runtime based on the capabilities of the CPU;
+ * the scalar implementation is used as a fallback.
+ *
+ * \param  log_xs         the logarithms of the sorted sample
+ * \param  n              the number of elements in the sample
+ * \param  alpha_minus_1  the exponent of the power-law minus one
+ * \param  log_xmin       the logarithm of xmin
+ * \param  cutoff         the calculation stops early as soon as the distance
+ *                        is known to be larger than this value. In that case,
+ *                        the returned value is larger than \c cutoff but it
+ *                        is not necessarily the true KS distance. Use
+ *                        \c DBL_MAX to always calculate the exact distance.
+ *
+ * \return the largest absolute difference between the two CDFs
+ */
+double plfit_ks_distance_continuous(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff);
+
+/**
+ * Same as \ref plfit_ks_distance_continuous(), but uses the given kernel.
+ * The kernel must be available on the current CPU; this is mostly useful for
+ * cross-checking the kernels against each other.
+ */
+double plfit_ks_distance_continuous_with_kernel(plfit_ks_kernel_t kernel,
+        const double* log_xs, size_t n, double alpha_minus_1, double log_xmin,
+        double cutoff);
+
+/**
+ * Same as \ref plfit_ks_distance_continuous(), but evaluates the CDFs only
+ * at the endpoints of fixed-size blocks first, and then bisects only those
+ * blocks where the distance may exceed the largest one seen so far.
+ *
+ * Both CDFs are monotone, so the distance within a block is bounded by the
+ * differences at its endpoints; blocks whose bound does not exceed the
+ * current maximum are skipped. The result is the same as the one of the
+ * scalar kernel, but typically only a small fraction of the sample has to
+ * be visited when the fit is good.
+ */
+double plfit_ks_distance_continuous_blocked(const double* log_xs, size_t n,
+        double alpha_minus_1, double log_xmin, double cutoff);
+
+__END_DECLS
+
+#endif /* __KS_KERNEL_H__ */
@@ -43,6 +43,8 @@ typedef struct _cmd_options_t {
     plfit_bool_t print_moments;
     plfit_p_value_method_t p_value_method;
     double p_value_precision;
+    double p_value_threshold;
+    const char* p_value_checkpoint;
     unsigned long seed;
     plfit_bool_t use_seed;
     double xmin;
@@ -79,6 +81,10 @@ void usage(char* argv[]) {
             "    -b        brief (but easily parseable) output format\n"
             "    -c        force continuous fitting even when every sample\n"
             "              is an integer\n"
+            "    -C FILE   save the progress of the exact p-value calculation to\n"
+            "              FILE periodically, and resume it from FILE if it exists.\n"
+            "              The resumed calculation gives the same p-value as an\n"
+            "              uninterrupted one. Only one input file may be given.\n"
             "    -D VALUE  divide each sample in the input data by VALUE to prevent\n"
             "              underflows when fitting discrete power-law distribution\n"
             "    -e EPS    try to provide a p-value with a precision of EPS when\n"
@@ -92,6 +98,10 @@ void usage(char* argv[]) {
             "              assessing the shape of the pdf it may have come from.\n"
             "    -p METHOD use METHOD to calculate the p-value. Must be one of\n"
             "              skip, approximate or exact. Default is skip.\n"
+            "    -P P0     stop the exact p-value calculation as soon as the p-value\n"
+            "              is known to be below or above P0 with high confidence.\n"
+            "              The number of synthetic datasets used is printed after\n"
+            "              the p-value.\n"
             "    -s SEED   use SEED to seed the random number generator\n"
     );
     return;
@@ -110,13 +120,15 @@ int parse_cmd_options(int argc, char* argv[], cmd_options_t* opts) {
     opts->print_moments = 0;
     opts->p_value_method = PLFIT_P_VALUE_SKIP;
     opts->p_value_precision = 0.01;
+    opts->p_value_threshold = 0;
+    opts->p_value_checkpoint = 0;
     opts->seed = 0;
     opts->use_seed = 0;
     opts->xmin = -1;
 
     opterr = 0;
 
-    while ((c = getopt(argc, argv, "a:bcD:e:fhm:Mp:ts:v")) != -1) {
+    while ((c = getopt(argc, argv, "a:bcC:D:e:fhm:Mp:P:ts:v")) != -1) {
         switch (c) {
             case 'a':
                 if (sscanf(optarg, "%lf:%lf:%lf", &opts->alpha_min,
@@ -134,6 +146,10 @@ int parse_cmd_options(int argc, char* argv[], cmd_options_t* opts) {
                 opts->force_continuous = 1;
                 break;
 
+            case 'C':           /* checkpoint file for the p-value calculation */
+                opts->p_value_checkpoint = optarg;
+                break;
+
             case 'D':           /* divide the input data */
                 if (!sscanf(optarg, "%lg", &opts->divisor) || opts->divisor <= 0) {
                     fprintf(stderr, "Invalid value for option `-%c'\n", optopt);
@@ -182,6 +198,14 @@ int parse_cmd_options(int argc, char* argv[], cmd_options_t* opts) {
                 }
                 break;
 
+            case 'P':           /* threshold for sequential p-value calculation */
+                if (!sscanf(optarg, "%lg", &opts->p_value_threshold) ||
+                        opts->p_value_threshold <= 0 || opts->p_value_threshold >= 1) {
+                    fprintf(stderr, "Invalid value for option `-%c'\n", optopt);
+                    return 1;
+                }
+                break;
+
             case 's':           /* set random seed */
                 if (!sscanf(optarg, "%lu", &opts->seed)) {
                     fprintf(stderr, "Invalid value for option `-%c'\n", optopt);
@@ -208,6 +232,11 @@ int parse_cmd_options(int argc, char* argv[], cmd_options_t* opts) {
         }
     }
 
+    if (opts->p_value_checkpoint && argc - optind > 1) {
+        fprintf(stderr, "Option `-C' can only be used with a single input file\n");
+        return 1;
+    }
+
     return -1;
 }
 
@@ -303,6 +332,10 @@ void process_file(FILE* f, const char* fname) {
     plfit_discrete_options.p_value_method = opts.p_value_method;
     plfit_continuous_options.p_value_precision = opts.p_value_precision;
     plfit_discrete_options.p_value_precision = opts.p_value_precision;
+    plfit_continuous_options.p_value_threshold = opts.p_value_threshold;
+    plfit_discrete_options.p_value_threshold = opts.p_value_threshold;
+    plfit_continuous_options.p_value_checkpoint = opts.p_value_checkpoint;
+    plfit_discrete_options.p_value_checkpoint = opts.p_value_checkpoint;
     plfit_continuous_options.rng = &rng;
     plfit_discrete_options.rng = &rng;
 
@@ -375,9 +408,13 @@ void process_file(FILE* f, const char* fname) {
         printf("\tL     = %12.5lf\n", result.L    );
         printf("\tD     = %12.5lf\n", result.D    );
         if (!isnan(result.p)) {
-            printf("\tp     = %12.5lf%s\n", result.p,
-                    opts.p_value_method == PLFIT_P_VALUE_APPROXIMATE ?
-                    " (approximation)" : "");
+            printf("\tp     = %12.5lf", result.p);
+            if (opts.p_value_method == PLFIT_P_VALUE_APPROXIMATE) {
+                printf(" (approximation)");
+            } else if (opts.p_value_threshold > 0) {
+                printf(" (%ld trials)", result.num_trials);
+            }
+            printf("\n");
         }
         printf("\n");
     }
@@ -40,6 +40,34 @@ void plfit_mt_init_from_rng(plfit_mt_rng_t* rng, plfit_mt_rng_t* seeder) {
     rng->mt_index = 0;
 }
 
+/* One step of the SplitMix64 generator of Steele, Lea and Flood */
+static uint64_t splitmix64_next(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void plfit_mt_init_from_stream(plfit_mt_rng_t* rng, uint64_t key, uint64_t stream) {
+    uint64_t state, value;
+    int i;
+
+    /* Scramble the key and the stream index separately so that nearby keys
+     * and nearby stream indices do not lead to overlapping sequences */
+    state = key;
+    state = splitmix64_next(&state);
+    value = stream;
+    state ^= splitmix64_next(&value);
+
+    for (i = 0; i < PLFIT_MT_LEN; i += 2) {
+        value = splitmix64_next(&state);
+        rng->mt_buffer[i] = (uint32_t) value;
+        rng->mt_buffer[i+1] = (uint32_t) (value >> 32);
+    }
+
+    rng->mt_index = 0;
+}
+
 #define MT_IA           397
 #define MT_IB           (PLFIT_MT_LEN - MT_IA)
 #define UPPER_MASK      0x80000000
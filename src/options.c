@@ -25,7 +25,13 @@ const plfit_continuous_options_t plfit_continuous_default_options = {
     /* .xmin_method = */ PLFIT_DEFAULT_CONTINUOUS_METHOD,
     /* .p_value_method = */ PLFIT_DEFAULT_P_VALUE_METHOD,
     /* .p_value_precision = */ 0.01,
-    /* .rng = */ 0
+    /* .rng = */ 0,
+    /* .hierarchical = */ {
+        /* .keep = */ 4,
+        /* .tolerance = */ 0
+    },
+    /* .p_value_threshold = */ 0,
+    /* .p_value_checkpoint = */ 0
 };
 
 const plfit_discrete_options_t plfit_discrete_default_options = {
@@ -38,7 +44,9 @@ const plfit_discrete_options_t plfit_discrete_default_options = {
     },
     /* .p_value_method = */ PLFIT_DEFAULT_P_VALUE_METHOD,
     /* .p_value_precision = */ 0.01,
-    /* .rng = */ 0
+    /* .rng = */ 0,
+    /* .p_value_threshold = */ 0,
+    /* .p_value_checkpoint = */ 0
 };
 
 int plfit_continuous_options_init(plfit_continuous_options_t* options) {
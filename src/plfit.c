@@ -28,7 +28,10 @@
 #include "lbfgs.h"
 #include "plfit.h"
 #include "kolmogorov.h"
+#include "ks_kernel.h"
+#include "sort.h"
 #include "hzeta.h"
+#include "checkpoint.h"
 
 /* #define PLFIT_DEBUG */
 
@@ -52,21 +55,293 @@ static int plfit_i_resample_continuous(const double* xs_head, size_t num_smaller
 static int plfit_i_resample_discrete(const double* xs_head, size_t num_smaller,
         size_t n, double alpha, double xmin, size_t num_samples, plfit_mt_rng_t* rng,
         double* result);
+static int plfit_i_resample_continuous_sorted(const double* xs_head, size_t num_smaller,
+        size_t n, double alpha, double xmin, size_t num_samples,
+        plfit_rbinom_state_t* binom_state, plfit_mt_rng_t* rng, double* result);
+static int plfit_i_resample_discrete_sorted(const double* xs_head, size_t num_smaller,
+        size_t n, double alpha, double xmin, size_t num_samples,
+        plfit_rbinom_state_t* binom_state, plfit_mt_rng_t* rng, double* result);
+static int plfit_i_continuous_sorted(const double* xs, size_t n, plfit_bool_t xmin_fixed,
+        double xmin, const plfit_continuous_options_t* options, plfit_result_t* result);
+static int plfit_i_discrete_sorted(const double* xs, size_t n, plfit_bool_t xmin_fixed,
+        double xmin, const plfit_discrete_options_t* options, plfit_result_t* result);
 
-static int double_comparator(const void *a, const void *b) {
-    const double *da = (const double*)a;
-    const double *db = (const double*)b;
-    return (*da > *db) - (*da < *db);
+/**
+ * Derives the key of the per-trial random number streams of a bootstrap from
+ * the random number generator given in the options. When no generator is
+ * given, the key is drawn from the built-in random number generator.
+ *
+ * Each trial seeds its own generator from the key and its index with
+ * \ref plfit_mt_init_from_stream(), so the outcome of the bootstrap does not
+ * depend on the number of threads or the order in which trials are run.
+ */
+static uint64_t plfit_i_bootstrap_stream_key(plfit_mt_rng_t* rng) {
+    plfit_mt_rng_t builtin_rng;
+
+    if (rng == 0) {
+        plfit_mt_init(&builtin_rng);
+        rng = &builtin_rng;
+    }
+
+    return (((uint64_t) plfit_mt_random(rng)) << 32) | plfit_mt_random(rng);
+}
+
+/**
+ * Probability with which the sequential exact p-value calculation may stop on
+ * the wrong side of the threshold given in the options.
+ */
+#define PLFIT_P_VALUE_SEQUENTIAL_RISK 1e-3
+
+/**
+ * Number of trials between two checks of the stopping rule of the sequential
+ * exact p-value calculation.
+ */
+#define PLFIT_P_VALUE_BATCH_SIZE 64
+
+/**
+ * Decides whether the sequential exact p-value calculation may stop, i.e.
+ * whether the p-value is known to lie below or above the threshold with high
+ * confidence after the given number of trials.
+ *
+ * By the Chernoff bound, the probability that the fraction of successes ends
+ * up at p_hat on the other side of the threshold than the true p-value is at
+ * most exp(-num_trials * KL(p_hat || threshold)), where KL is the
+ * Kullback-Leibler divergence of two Bernoulli distributions. The k-th check
+ * may err with probability risk / (k * (k+1)), so the probability of stopping
+ * on the wrong side over all the checks is at most
+ * \ref PLFIT_P_VALUE_SEQUENTIAL_RISK.
+ */
+static plfit_bool_t plfit_i_p_value_decided(long int successes, long int num_trials,
+        double threshold, long int k) {
+    double p_hat = successes / (double)num_trials;
+    double kl = 0;
+
+    if (p_hat > 0)
+        kl += p_hat * log(p_hat / threshold);
+    if (p_hat < 1)
+        kl += (1 - p_hat) * log((1 - p_hat) / (1 - threshold));
+
+    return num_trials * kl >= log(k * (k + 1.0) / PLFIT_P_VALUE_SEQUENTIAL_RISK);
 }
 
-static int plfit_i_copy_and_sort(const double* xs, size_t n, double** result) {
-    *result = (double*)malloc(sizeof(double) * n);
+/**
+ * Initializes the checkpoint of an exact p-value calculation and, if the
+ * options name a checkpoint file that exists, resumes the calculation from
+ * the progress saved there.
+ *
+ * The saved checkpoint must belong to the same calculation. Its stream key
+ * takes precedence over the one derived from the RNG in the options, so the
+ * resumed calculation draws the same random numbers as the original one.
+ */
+static int plfit_i_p_value_checkpoint_init(plfit_p_value_checkpoint_t* checkpoint,
+        const char* path, char kind, size_t n, const plfit_result_t* result,
+        double precision, double threshold, plfit_bool_t xmin_fixed,
+        uint64_t stream_key, long int num_trials) {
+    plfit_p_value_checkpoint_t saved;
+    plfit_bool_t found;
+
+    checkpoint->kind = kind;
+    checkpoint->n = n;
+    checkpoint->xmin = result->xmin;
+    checkpoint->alpha = result->alpha;
+    checkpoint->D = result->D;
+    checkpoint->precision = precision;
+    checkpoint->threshold = threshold;
+    checkpoint->xmin_fixed = xmin_fixed;
+    checkpoint->stream_key = stream_key;
+    checkpoint->num_trials = 0;
+    checkpoint->successes = 0;
+    checkpoint->num_checks = 0;
+    checkpoint->stopped = 0;
+
+    if (path == NULL) {
+        return PLFIT_SUCCESS;
+    }
+
+    PLFIT_CHECK(plfit_p_value_checkpoint_read(path, &saved, &found));
+    if (found) {
+        if (!plfit_p_value_checkpoint_matches(&saved, checkpoint) ||
+                saved.num_trials > num_trials) {
+            PLFIT_ERROR("checkpoint file belongs to a different p-value calculation",
+                    PLFIT_EINVAL);
+        }
+        *checkpoint = saved;
+    }
+
+    return PLFIT_SUCCESS;
+}
+
+/**
+ * Runs a single trial of an exact p-value calculation: draws a synthetic
+ * dataset from the fitted distribution into \c ys, fits it and returns the
+ * D-score of the fit in \c D.
+ *
+ * The random numbers must be drawn from \c rng and the binomial sampler
+ * \c binom_state only, both of which belong to the calling thread.
+ */
+typedef int plfit_i_p_value_trial_t(const void* data, plfit_mt_rng_t* rng,
+        plfit_rbinom_state_t* binom_state, double* ys, double* D);
+
+/**
+ * Calculates an exact p-value by running the given trial on synthetic
+ * datasets of \c n elements, and stores the p-value and the number of trials
+ * used in \c result. The fitted parameters and D-score of the original data
+ * are taken from \c result as well.
+ *
+ * The trials are run in parallel, in batches of
+ * \ref PLFIT_P_VALUE_BATCH_SIZE if a threshold or a checkpoint file is given.
+ * After each batch, the sequential stopping rule is checked and the progress
+ * is saved to the checkpoint file.
+ */
+static int plfit_i_calculate_p_value_exact(char kind, size_t n, double precision,
+        double threshold, const char* checkpoint_path, plfit_mt_rng_t* rng,
+        plfit_bool_t xmin_fixed, plfit_i_p_value_trial_t* trial, const void* data,
+        plfit_result_t* result) {
+    long int num_trials;
+    long int successes, trials_used, batch_size, num_checks;
+    plfit_p_value_checkpoint_t checkpoint;
+    plfit_bool_t stop;
+    int retval = PLFIT_SUCCESS;
+
+    num_trials = (long int)(0.25 / precision / precision);
+    if (num_trials <= 0) {
+        PLFIT_ERROR("invalid p-value precision", PLFIT_EINVAL);
+    }
+    if (!(threshold >= 0 && threshold < 1)) {
+        PLFIT_ERROR("p-value threshold must be in [0; 1)", PLFIT_EINVAL);
+    }
+
+    /* Without a threshold or a checkpoint file, all the trials form a single
+     * batch */
+    batch_size = (threshold > 0 || checkpoint_path) ?
+        PLFIT_P_VALUE_BATCH_SIZE : num_trials;
+
+    PLFIT_CHECK(plfit_i_p_value_checkpoint_init(&checkpoint, checkpoint_path,
+                kind, n, result, precision, threshold, xmin_fixed,
+                plfit_i_bootstrap_stream_key(rng), num_trials));
+    successes = checkpoint.successes;
+    trials_used = checkpoint.num_trials;
+    num_checks = checkpoint.num_checks;
+    stop = checkpoint.stopped;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        /* Parallel section starts here. Each trial draws its random numbers
+         * from its own stream that depends only on the stream key and the
+         * index of the trial, so the trials may be distributed among the
+         * threads in any order and the p-value stays reproducible. Each
+         * thread has its own binomial sampler as well, whose setup is reused
+         * across the trials of the thread. */
+        plfit_mt_rng_t trial_rng;
+        plfit_rbinom_state_t binom_state;
+        double *ys;
+        double D;
+        long int i, batch_start, batch_end;
+        int trial_retval;
+
+        plfit_rbinom_state_init(&binom_state);
+
+        /* Allocate memory to sample into. Errors are recorded in a critical
+         * section by any thread; retval is only read after the barrier at the
+         * end of the trial loop of a batch, and after the parallel region. */
+        ys = calloc(n > 0 ? n : 1, sizeof(double));
+        if (ys == NULL) {
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            retval = PLFIT_ENOMEM;
+        }
+
+        /* The trials are run in batches, starting from where the checkpoint
+         * left off. After each batch, the sequential stopping rule decides
+         * whether the p-value is already known to be on one side of the
+         * threshold, and the progress is saved to the checkpoint file. */
+        for (batch_start = trials_used; batch_start < num_trials && !stop;
+                batch_start = batch_end) {
+            batch_end = num_trials - batch_start > batch_size ?
+                batch_start + batch_size : num_trials;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) reduction(+:successes)
+#endif
+            for (i = batch_start; i < batch_end; i++) {
+                if (ys == NULL)
+                    continue;
+                plfit_mt_init_from_stream(&trial_rng, checkpoint.stream_key, (uint64_t) i);
+                trial_retval = trial(data, &trial_rng, &binom_state, ys, &D);
+                if (trial_retval != PLFIT_SUCCESS) {
+                    /* The D-score of a failed trial is meaningless; the error
+                     * ends the calculation after this batch */
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                    retval = trial_retval;
+                    continue;
+                }
+                if (D > result->D)
+                    successes++;
+            }
+
+#ifdef _OPENMP
+#pragma omp single
+#endif
+            {
+                trials_used = batch_end;
+                num_checks++;
+                if (retval != PLFIT_SUCCESS) {
+                    stop = 1;
+                } else {
+                    if (threshold > 0) {
+                        stop = plfit_i_p_value_decided(successes, trials_used,
+                                threshold, num_checks);
+                    }
+                    if (checkpoint_path) {
+                        checkpoint.num_trials = trials_used;
+                        checkpoint.successes = successes;
+                        checkpoint.num_checks = num_checks;
+                        checkpoint.stopped = stop;
+                        retval = plfit_p_value_checkpoint_write(checkpoint_path,
+                                &checkpoint);
+                        if (retval != PLFIT_SUCCESS) {
+                            stop = 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        free(ys);
+
+        /* End of parallelized part */
+    }
+
+    if (retval == PLFIT_SUCCESS) {
+        result->p = successes / ((double)trials_used);
+        result->num_trials = trials_used;
+    } else {
+        PLFIT_ERROR("cannot calculate exact p-value", retval);
+    }
+
+    return retval;
+}
+
+static int plfit_i_copy_and_sort(const double* xs, size_t n, double** result,
+        plfit_sorted_runs_t* runs) {
+    int retval;
+
+    *result = (double*)malloc(sizeof(double) * (n > 0 ? n : 1));
     if (*result == NULL) {
         PLFIT_ERROR("cannot create sorted copy of input data", PLFIT_ENOMEM);
     }
 
-    memcpy(*result, xs, sizeof(double) * n);
-    qsort(*result, n, sizeof(double), double_comparator);
+    retval = plfit_sort_doubles(xs, n, *result, runs);
+    if (retval) {
+        free(*result);
+        *result = NULL;
+        return retval;
+    }
 
     return PLFIT_SUCCESS;
 }
@@ -132,260 +407,377 @@ static double* extract_smaller(const double* begin, const double* end, double xm
 }
 
 /**
- * Given a sorted array of doubles, return another array that contains pointers
- * into the array for the start of each block of identical elements.
+ * Given an array of doubles, return another array that contains the
+ * logarithms of the elements.
  *
  * \param  begin          pointer to the beginning of the array
  * \param  end            pointer to the first element after the end of the array
- * \param  result_length  if not \c NULL, the number of unique elements in the
- *                        given array is returned here. It is left unchanged if
- *                        the function returns with an error.
  *
  * \return pointer to the head of the new array or NULL if there is not enough
  * memory
  */
-static double** unique_element_pointers(double* begin, double* end, size_t* result_length) {
-    double* ptr = begin;
-    double** result;
-    double prev_x;
-    size_t num_elts = 15;
-    size_t used_elts = 0;
-
-    /* Special case: empty array */
-    if (begin == end) {
-        result = calloc(1, sizeof(double*));
-        if (result != NULL) {
-            result[0] = 0;
-            if (result_length != 0) {
-                *result_length = 0;
-            }
-        }
-        return result;
+static double* log_transform(const double* begin, const double* end) {
+    size_t i, n = end - begin;
+    double* result;
+
+    result = (double*)malloc(sizeof(double) * (n > 0 ? n : 1));
+    if (result == NULL)
+        return NULL;
+
+    for (i = 0; i < n; i++) {
+        result[i] = log(begin[i]);
     }
 
-    /* Allocate initial result array, including the guard element */
-    result = calloc(num_elts+1, sizeof(double*));
+    return result;
+}
+
+/**
+ * Given an array of doubles, return another array that contains the suffix
+ * sums of the elements; i.e. the i-th element of the result is the sum of
+ * x_j for all j >= i.
+ *
+ * \param  begin          pointer to the beginning of the array
+ * \param  end            pointer to the first element after the end of the array
+ *
+ * \return pointer to the head of the new array or NULL if there is not enough
+ * memory. The new array has a guard element at the end that is always zero.
+ */
+static double* suffix_sums(const double* begin, const double* end) {
+    size_t n = end - begin;
+    double* result;
+
+    result = (double*)malloc(sizeof(double) * (n+1));
     if (result == NULL)
         return NULL;
 
-    prev_x = *begin;
-    result[used_elts++] = begin;
+    result[n] = 0.0;
+    while (n > 0) {
+        n--;
+        result[n] = result[n+1] + begin[n];
+    }
 
-    /* Process the input array */
-    for (ptr = begin+1; ptr < end; ptr++) {
-        if (*ptr == prev_x)
-            continue;
+    return result;
+}
 
-        /* New block found */
-        if (used_elts >= num_elts) {
-            /* Array full; allocate a new chunk */
-            double** tmp;
-            num_elts = num_elts*2 + 1;
-            tmp = realloc(result, sizeof(double*) * (num_elts+1));
-            if (tmp == NULL) {
-                free(result);
-                return NULL;
-            }
-            result = tmp;
-        }
+/********** Prepared datasets **********/
+
+static int plfit_i_dataset_init(plfit_dataset_t* dataset, const double* xs, size_t n,
+        plfit_bool_t with_runs) {
+    plfit_sorted_runs_t* runs = NULL;
+    int retval;
 
-        /* Store the new element */
-        result[used_elts++] = ptr;
-        prev_x = *ptr;
+    dataset->xs = NULL;
+    dataset->n = n;
+    dataset->logs = NULL;
+    dataset->logsums = NULL;
+    dataset->runs = NULL;
+
+    /* The runs are cheap to find while sorting, so we do it right away if
+     * the caller knows that they will be needed */
+    if (with_runs) {
+        runs = (plfit_sorted_runs_t*)malloc(sizeof(plfit_sorted_runs_t));
+        if (runs == NULL) {
+            PLFIT_ERROR("cannot prepare dataset", PLFIT_ENOMEM);
+        }
     }
 
-    /* Calculate the result length */
-    if (result_length != 0) {
-        *result_length = used_elts;
+    retval = plfit_i_copy_and_sort(xs, n, &dataset->xs, runs);
+    if (retval) {
+        free(runs);
+        return retval;
     }
 
-    /* Add the guard entry to the end of the result */
-    result[used_elts++] = 0;
+    dataset->runs = runs;
 
-    return result;
+    return PLFIT_SUCCESS;
 }
 
-static void plfit_i_perform_finite_size_correction(plfit_result_t* result, size_t n) {
-    result->alpha = result->alpha * (n-1) / n + 1.0 / n;
+int plfit_dataset_init(plfit_dataset_t* dataset, const double* xs, size_t n) {
+    return plfit_i_dataset_init(dataset, xs, n, /* with_runs = */ 0);
 }
 
-/********** Continuous power law distribution fitting **********/
+/**
+ * Prepares a dataset from data that is already sorted in increasing order.
+ * The data is copied without sorting it again; the blocks of identical
+ * elements are found with a linear scan when they are needed.
+ */
+static int plfit_i_dataset_init_sorted(plfit_dataset_t* dataset, const double* xs,
+        size_t n) {
+    dataset->n = n;
+    dataset->logs = NULL;
+    dataset->logsums = NULL;
+    dataset->runs = NULL;
+    dataset->xs = (double*)malloc(sizeof(double) * (n > 0 ? n : 1));
+    if (dataset->xs == NULL) {
+        PLFIT_ERROR("cannot prepare dataset", PLFIT_ENOMEM);
+    }
 
-static void plfit_i_logsum_less_than_continuous(const double* begin, const double* end,
-        double xmin, double* result, size_t* m) {
-    double logsum = 0.0;
-    size_t count = 0;
+    memcpy(dataset->xs, xs, sizeof(double) * n);
 
-    for (; begin != end; begin++) {
-        if (*begin >= xmin) {
-            count++;
-            logsum += log(*begin / xmin);
+    return PLFIT_SUCCESS;
+}
+
+void plfit_dataset_destroy(plfit_dataset_t* dataset) {
+    if (dataset->runs) {
+        plfit_sorted_runs_destroy((plfit_sorted_runs_t*)dataset->runs);
+        free(dataset->runs);
+    }
+    free(dataset->logsums);
+    free(dataset->logs);
+    free(dataset->xs);
+
+    dataset->xs = NULL;
+    dataset->n = 0;
+    dataset->logs = NULL;
+    dataset->logsums = NULL;
+    dataset->runs = NULL;
+}
+
+/**
+ * Returns the index of the first element of the dataset that is not smaller
+ * than the given value, or the number of elements if there is no such element.
+ */
+static size_t plfit_i_dataset_tail(const plfit_dataset_t* dataset, double xmin) {
+    size_t lo = 0, hi = dataset->n, mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (dataset->xs[mid] < xmin) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
         }
     }
 
-    *m = count;
-    *result = logsum;
+    return lo;
 }
 
-static double plfit_i_logsum_continuous(const double* begin, const double* end, double xmin) {
-    double logsum = 0.0;
-    for (; begin != end; begin++)
-        logsum += log(*begin / xmin);
-    return logsum;
-}
+/**
+ * Prepares a dataset for fits with a fixed xmin, sorting only the elements
+ * that are not smaller than xmin.
+ *
+ * The elements smaller than xmin are copied to the head of the dataset in
+ * their original order, followed by the remaining elements in sorted order.
+ * The logarithms and their suffix sums are calculated for the tail only; the
+ * head is filled with NaNs. Binary searches for values not smaller than xmin
+ * still work on such a dataset, but it must not be used with smaller xmin
+ * values or with the xmin scans.
+ *
+ * When \c sorted is true, the input is trusted to be sorted already and it
+ * is copied as is.
+ */
+static int plfit_i_dataset_init_tail(plfit_dataset_t* dataset, const double* xs,
+        size_t n, double xmin, plfit_bool_t sorted) {
+    size_t i, num_smaller, num_tail;
+    int retval;
 
-static int plfit_i_estimate_alpha_continuous(const double* xs, size_t n,
-        double xmin, double* alpha) {
-    double result;
-    size_t m;
+    dataset->n = n;
+    dataset->runs = NULL;
+    dataset->xs = (double*)malloc(sizeof(double) * (n > 0 ? n : 1));
+    dataset->logs = (double*)malloc(sizeof(double) * (n > 0 ? n : 1));
+    dataset->logsums = (double*)malloc(sizeof(double) * (n + 1));
+    if (dataset->xs == NULL || dataset->logs == NULL || dataset->logsums == NULL) {
+        plfit_dataset_destroy(dataset);
+        PLFIT_ERROR("cannot prepare dataset", PLFIT_ENOMEM);
+    }
 
-    XMIN_CHECK_ZERO;
+    if (sorted) {
+        memcpy(dataset->xs, xs, sizeof(double) * n);
+        num_smaller = plfit_i_dataset_tail(dataset, xmin);
+    } else {
+        /* Partition the data around xmin, using the space of the logarithms
+         * for the tail, then sort the tail into its final place */
+        for (i = 0, num_smaller = 0, num_tail = 0; i < n; i++) {
+            if (xs[i] < xmin) {
+                dataset->xs[num_smaller++] = xs[i];
+            } else {
+                dataset->logs[num_tail++] = xs[i];
+            }
+        }
+
+        retval = num_tail > 0 ? plfit_sort_doubles(dataset->logs, num_tail,
+                dataset->xs + num_smaller, NULL) : PLFIT_SUCCESS;
+        if (retval) {
+            plfit_dataset_destroy(dataset);
+            return retval;
+        }
+    }
 
-    plfit_i_logsum_less_than_continuous(xs, xs+n, xmin, &result, &m);
+    dataset->logsums[n] = 0.0;
+    for (i = n; i > num_smaller; i--) {
+        dataset->logs[i-1] = log(dataset->xs[i-1]);
+        dataset->logsums[i-1] = dataset->logsums[i] + dataset->logs[i-1];
+    }
+    for (i = 0; i < num_smaller; i++) {
+        dataset->logs[i] = NAN;
+        dataset->logsums[i] = NAN;
+    }
 
-    if (m == 0) {
-        PLFIT_ERROR("no data point was larger than xmin", PLFIT_EINVAL);
+    return PLFIT_SUCCESS;
+}
+
+/**
+ * Makes sure that the logarithms of the elements of the dataset and their
+ * suffix sums are calculated.
+ */
+static int plfit_i_dataset_prepare_logs(plfit_dataset_t* dataset) {
+    if (dataset->logs == NULL) {
+        dataset->logs = log_transform(dataset->xs, dataset->xs + dataset->n);
+        if (dataset->logs == NULL) {
+            PLFIT_ERROR("cannot calculate logarithms of dataset", PLFIT_ENOMEM);
+        }
     }
 
-    *alpha = 1 + m / result;
+    if (dataset->logsums == NULL) {
+        dataset->logsums = suffix_sums(dataset->logs, dataset->logs + dataset->n);
+        if (dataset->logsums == NULL) {
+            PLFIT_ERROR("cannot calculate logarithms of dataset", PLFIT_ENOMEM);
+        }
+    }
 
     return PLFIT_SUCCESS;
 }
 
-static int plfit_i_estimate_alpha_continuous_sorted(const double* xs, size_t n,
-        double xmin, double* alpha) {
-    const double* end = xs+n;
+/**
+ * Returns the blocks of identical elements of the dataset, finding them first
+ * if needed.
+ */
+static int plfit_i_dataset_get_runs(plfit_dataset_t* dataset,
+        const plfit_sorted_runs_t** result) {
+    plfit_sorted_runs_t* runs;
+    int retval;
 
-    XMIN_CHECK_ZERO;
+    if (dataset->runs == NULL) {
+        runs = (plfit_sorted_runs_t*)malloc(sizeof(plfit_sorted_runs_t));
+        if (runs == NULL) {
+            PLFIT_ERROR("cannot find unique elements of dataset", PLFIT_ENOMEM);
+        }
 
-    for (; xs != end && *xs < xmin; xs++);
-    if (xs == end) {
-        PLFIT_ERROR("no data point was larger than xmin", PLFIT_EINVAL);
+        retval = plfit_sorted_runs_init(runs, dataset->xs, dataset->n);
+        if (retval) {
+            free(runs);
+            return retval;
+        }
+
+        dataset->runs = runs;
     }
 
-    *alpha = 1 + (end-xs) / plfit_i_logsum_continuous(xs, end, xmin);
+    *result = (const plfit_sorted_runs_t*)dataset->runs;
 
     return PLFIT_SUCCESS;
 }
 
-static int plfit_i_ks_test_continuous(const double* xs, const double* xs_end,
-        const double alpha, const double xmin, double* D) {
-    /* Assumption: xs is sorted and cut off at xmin so the first element is
-     * always larger than or equal to xmin. */
-    double result = 0, n;
-    int m = 0;
+static void plfit_i_perform_finite_size_correction(plfit_result_t* result, size_t n) {
+    result->alpha = result->alpha * (n-1) / n + 1.0 / n;
+}
 
-    n = xs_end - xs;
+/********** Continuous power law distribution fitting **********/
 
-    while (xs < xs_end) {
-        double d = fabs(1-pow(xmin / *xs, alpha-1) - m / n);
+static void plfit_i_logsum_less_than_continuous(const double* begin, const double* end,
+        double xmin, double* result, size_t* m) {
+    double logsum = 0.0;
+    size_t count = 0;
 
-        if (d > result)
-            result = d;
+    for (; begin != end; begin++) {
+        if (*begin >= xmin) {
+            count++;
+            logsum += log(*begin / xmin);
+        }
+    }
+
+    *m = count;
+    *result = logsum;
+}
+
+/**
+ * Calculates the MLE of alpha for a continuous power-law with a given xmin
+ * from the number of samples in the tail and the sum of their logarithms,
+ * which callers look up in a table of suffix log-sums in constant time.
+ */
+static double plfit_i_estimate_alpha_continuous_from_logsum(size_t m,
+        double logsum, double xmin) {
+    return 1 + m / (logsum - m * log(xmin));
+}
 
-        xs++; m++;
+static int plfit_i_ks_test_continuous(const double* log_xs, const double* log_xs_end,
+        const double alpha, const double log_xmin, const double cutoff, double* D) {
+    /* Assumption: log_xs contains the logarithms of a sorted sample that is
+     * cut off at xmin so the first element is always larger than or equal to
+     * log(xmin). The fitted CDF is 1 - (xmin/x)^(alpha-1), which is evaluated
+     * in the log domain by a (possibly vectorized) kernel that is selected
+     * at runtime. Long samples are split into blocks instead, and blocks
+     * whose endpoints show that they cannot contain the maximum are skipped.
+     * Both stop as soon as the running maximum exceeds the cutoff; the value
+     * of D is then larger than the cutoff but it is not necessarily the
+     * exact KS statistic. */
+    size_t n = log_xs_end - log_xs;
+
+    if (n >= PLFIT_KS_BLOCKED_THRESHOLD) {
+        *D = plfit_ks_distance_continuous_blocked(log_xs, n, alpha - 1, log_xmin,
+                cutoff);
+    } else {
+        *D = plfit_ks_distance_continuous(log_xs, n, alpha - 1, log_xmin, cutoff);
     }
+    return PLFIT_SUCCESS;
+}
 
-    *D = result;
+/* Parameters of a trial of the exact p-value calculation for continuous data */
+typedef struct {
+    const double* xs_head;  /**< Elements of the dataset smaller than xmin, sorted */
+    size_t num_smaller;     /**< Number of elements smaller than xmin */
+    size_t n;               /**< Number of elements in the dataset */
+    plfit_bool_t xmin_fixed; /**< Whether the synthetic fits keep xmin fixed */
+    const plfit_result_t* result; /**< The fit of the original dataset */
+    plfit_continuous_options_t options; /**< Options of the synthetic fits */
+} plfit_i_p_value_trial_continuous_t;
+
+static int plfit_i_p_value_trial_continuous(const void* data, plfit_mt_rng_t* rng,
+        plfit_rbinom_state_t* binom_state, double* ys, double* D) {
+    const plfit_i_p_value_trial_continuous_t* trial = (const plfit_i_p_value_trial_continuous_t*)data;
+    plfit_result_t result_synthetic;
+
+    PLFIT_CHECK(plfit_i_resample_continuous_sorted(trial->xs_head, trial->num_smaller,
+                trial->n, trial->result->alpha, trial->result->xmin, trial->n,
+                binom_state, rng, ys));
+    PLFIT_CHECK(plfit_i_continuous_sorted(ys, trial->n, trial->xmin_fixed,
+                trial->result->xmin, &trial->options, &result_synthetic));
+    *D = result_synthetic.D;
 
     return PLFIT_SUCCESS;
 }
 
-static int plfit_i_calculate_p_value_continuous(const double* xs, size_t n,
+static int plfit_i_calculate_p_value_continuous(const plfit_dataset_t* dataset,
         const plfit_continuous_options_t *options, plfit_bool_t xmin_fixed,
         plfit_result_t *result) {
-    long int num_trials;
-    long int successes = 0;
-    double *xs_head;
-    size_t num_smaller;
-    plfit_continuous_options_t options_no_p_value = *options;
-    int retval = PLFIT_SUCCESS;
+    plfit_i_p_value_trial_continuous_t trial;
+    size_t n = dataset->n, num_smaller;
 
     if (options->p_value_method == PLFIT_P_VALUE_SKIP) {
         result->p = NAN;
+        result->num_trials = 0;
         return PLFIT_SUCCESS;
     }
 
+    /* The dataset is sorted so the elements smaller than xmin form its head */
+    num_smaller = plfit_i_dataset_tail(dataset, result->xmin);
+
     if (options->p_value_method == PLFIT_P_VALUE_APPROXIMATE) {
-        num_smaller = count_smaller(xs, xs + n, result->xmin);
         result->p = plfit_ks_test_one_sample_p(result->D, n - num_smaller);
+        result->num_trials = 0;
         return PLFIT_SUCCESS;
     }
 
-    options_no_p_value.p_value_method = PLFIT_P_VALUE_SKIP;
-    num_trials = (long int)(0.25 / options->p_value_precision / options->p_value_precision);
-    if (num_trials <= 0) {
-        PLFIT_ERROR("invalid p-value precision", PLFIT_EINVAL);
-    }
-
-    /* Extract the head of xs that contains elements smaller than xmin */
-    xs_head = extract_smaller(xs, xs+n, result->xmin, &num_smaller);
-    if (xs_head == 0)
-        PLFIT_ERROR("cannot calculate exact p-value", PLFIT_ENOMEM);
-
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-    {
-        /* Parallel section starts here. If we are compiling using OpenMP, each
-         * thread will use its own RNG that is seeded from the master RNG. If
-         * we are compiling without OpenMP, there is only one thread and it uses
-         * the master RNG. This section must be critical to ensure that only one
-         * thread is using the master RNG at the same time. */
-#ifdef _OPENMP
-        plfit_mt_rng_t private_rng;
-#endif
-        plfit_mt_rng_t *p_rng;
-        double *ys;
-        long int i;
-        plfit_result_t result_synthetic;
-
-#ifdef _OPENMP
-#pragma omp critical
-        {
-            p_rng = &private_rng;
-            plfit_mt_init_from_rng(p_rng, options->rng);
-        }
-#else
-        p_rng = options->rng;
-#endif
-
-        /* Allocate memory to sample into */
-        ys = calloc(n > 0 ? n : 1, sizeof(double));
-        if (ys == 0) {
-            retval = PLFIT_ENOMEM;
-        } else {
-            /* The main for loop starts here. */
-#ifdef _OPENMP
-#pragma omp for reduction(+:successes)
-#endif
-            for (i = 0; i < num_trials; i++) {
-                plfit_i_resample_continuous(xs_head, num_smaller, n, result->alpha,
-                        result->xmin, n, p_rng, ys);
-                if (xmin_fixed) {
-                    plfit_estimate_alpha_continuous(ys, n, result->xmin,
-                                &options_no_p_value, &result_synthetic);
-                } else {
-                    plfit_continuous(ys, n, &options_no_p_value, &result_synthetic);
-                }
-                if (result_synthetic.D > result->D)
-                    successes++;
-            }
-            free(ys);
-        }
-
-        /* End of parallelized part */
-    }
-
-    free(xs_head);
-
-    if (retval == PLFIT_SUCCESS) {
-        result->p = successes / ((double)num_trials);
-    } else {
-        PLFIT_ERROR("cannot calculate exact p-value", retval);
-    }
-
-    return retval;
+    trial.xs_head = dataset->xs;
+    trial.num_smaller = num_smaller;
+    trial.n = n;
+    trial.xmin_fixed = xmin_fixed;
+    trial.result = result;
+    trial.options = *options;
+    trial.options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+    return plfit_i_calculate_p_value_exact('C', n, options->p_value_precision,
+            options->p_value_threshold, options->p_value_checkpoint, options->rng,
+            xmin_fixed, plfit_i_p_value_trial_continuous, &trial, result);
 }
 
 int plfit_log_likelihood_continuous(const double* xs, size_t n, double alpha,
@@ -405,71 +797,116 @@ int plfit_log_likelihood_continuous(const double* xs, size_t n, double alpha,
     return PLFIT_SUCCESS;
 }
 
-int plfit_estimate_alpha_continuous_sorted(const double* xs, size_t n, double xmin,
+int plfit_log_likelihood_continuous_dataset(plfit_dataset_t* dataset, double alpha,
+        double xmin, double* L) {
+    size_t offset, m;
+
+    if (alpha <= 1) {
+        PLFIT_ERROR("alpha must be greater than one", PLFIT_EINVAL);
+    }
+    XMIN_CHECK_ZERO;
+
+    PLFIT_CHECK(plfit_i_dataset_prepare_logs(dataset));
+
+    offset = plfit_i_dataset_tail(dataset, xmin);
+    m = dataset->n - offset;
+    *L = -alpha * (dataset->logsums[offset] - m * log(xmin)) + log((alpha - 1) / xmin) * m;
+
+    return PLFIT_SUCCESS;
+}
+
+int plfit_estimate_alpha_continuous_dataset(plfit_dataset_t* dataset, double xmin,
         const plfit_continuous_options_t* options, plfit_result_t *result) {
-    const double *begin, *end;
+    size_t offset, m;
 
     if (!options)
         options = &plfit_continuous_default_options;
 
-    begin = xs;
-    end = xs + n;
-    while (begin < end && *begin < xmin)
-        begin++;
+    XMIN_CHECK_ZERO;
 
-    PLFIT_CHECK(plfit_i_estimate_alpha_continuous_sorted(begin, end-begin,
-                xmin, &result->alpha));
-    PLFIT_CHECK(plfit_i_ks_test_continuous(begin, end, result->alpha,
-                xmin, &result->D));
+    PLFIT_CHECK(plfit_i_dataset_prepare_logs(dataset));
+
+    offset = plfit_i_dataset_tail(dataset, xmin);
+    m = dataset->n - offset;
+    if (m == 0) {
+        PLFIT_ERROR("no data point was larger than xmin", PLFIT_EINVAL);
+    }
+
+    result->alpha = plfit_i_estimate_alpha_continuous_from_logsum(m,
+            dataset->logsums[offset], xmin);
+    PLFIT_CHECK(plfit_i_ks_test_continuous(dataset->logs + offset,
+                dataset->logs + dataset->n, result->alpha, log(xmin), DBL_MAX,
+                &result->D));
 
     if (options->finite_size_correction)
-        plfit_i_perform_finite_size_correction(result, end-begin);
+        plfit_i_perform_finite_size_correction(result, m);
     result->xmin = xmin;
 
-    PLFIT_CHECK(plfit_log_likelihood_continuous(begin, end-begin, result->alpha,
+    PLFIT_CHECK(plfit_log_likelihood_continuous_dataset(dataset, result->alpha,
                 result->xmin, &result->L));
-    PLFIT_CHECK(plfit_i_calculate_p_value_continuous(xs, n, options, 1, result));
+    PLFIT_CHECK(plfit_i_calculate_p_value_continuous(dataset, options, 1, result));
 
     return PLFIT_SUCCESS;
 }
 
 int plfit_estimate_alpha_continuous(const double* xs, size_t n, double xmin,
         const plfit_continuous_options_t* options, plfit_result_t *result) {
-    double *xs_copy;
-
-    if (!options)
-        options = &plfit_continuous_default_options;
+    plfit_dataset_t dataset;
+    int retval;
 
-    PLFIT_CHECK(plfit_i_copy_and_sort(xs, n, &xs_copy));
-    PLFIT_CHECK(plfit_estimate_alpha_continuous_sorted(xs_copy, n, xmin,
-                options, result));
-    free(xs_copy);
+    /* Only the tail above xmin has to be sorted; the head is needed for
+     * the p-value calculation but its order does not matter */
+    PLFIT_CHECK(plfit_i_dataset_init_tail(&dataset, xs, n, xmin, /* sorted = */ 0));
+    retval = plfit_estimate_alpha_continuous_dataset(&dataset, xmin, options, result);
+    plfit_dataset_destroy(&dataset);
 
-    return PLFIT_SUCCESS;
+    return retval;
 }
 
 typedef struct {
     double *begin;        /**< Pointer to the beginning of the array holding the data */
     double *end;          /**< Pointer to after the end of the array holding the data */
-    double **probes;      /**< Pointers to the elements of the array that will be probed */
+    double *logs;         /**< Logarithms of the elements of the array, aligned with begin */
+    double *logsums;      /**< Suffix sums of logs, aligned with begin */
+    const plfit_sorted_runs_t* runs; /**< Runs of identical elements in the array */
+    size_t first_probe;   /**< Index of the run that is probed first */
+    size_t probe_stride;  /**< Number of runs between consecutive probes */
     size_t num_probes;    /**< Number of probes */
+    double cutoff;        /**< Evaluations may stop early once D is known to exceed this */
     plfit_result_t last;  /**< Result of the last evaluation */
 } plfit_continuous_xmin_opt_data_t;
 
+/* Returns the offset of the first element of the given probe within the
+ * sorted array */
+static size_t plfit_i_continuous_xmin_opt_probe(const plfit_continuous_xmin_opt_data_t* data,
+        size_t i) {
+    return plfit_sorted_runs_start(data->runs, data->first_probe + i * data->probe_stride);
+}
+
 static double plfit_i_continuous_xmin_opt_evaluate(void* instance, double x) {
     plfit_continuous_xmin_opt_data_t* data = (plfit_continuous_xmin_opt_data_t*)instance;
-    double* begin = data->probes[(long int)x];
+    size_t offset = plfit_i_continuous_xmin_opt_probe(data, (size_t)x);
+    double* begin = data->begin + offset;
 
     data->last.xmin = *begin;
 
 #ifdef PLFIT_DEBUG
-    printf("Trying with probes[%ld] = %.4f\n", (long int)x, *begin);
+    printf("Trying with probe #%ld = %.4f\n", (long int)x, *begin);
 #endif
 
-    plfit_i_estimate_alpha_continuous_sorted(begin, data->end-begin, *begin,
-            &data->last.alpha);
-    plfit_i_ks_test_continuous(begin, data->end, data->last.alpha, *begin,
-            &data->last.D);
+    if (*begin <= 0) {
+        /* Report the error the same way as the estimator would, and make sure
+         * that this candidate is never selected if the error is ignored */
+        plfit_error("xmin must be greater than zero", __FILE__, __LINE__, PLFIT_EINVAL);
+        data->last.alpha = NAN;
+        data->last.D = DBL_MAX;
+        return data->last.D;
+    }
+
+    data->last.alpha = plfit_i_estimate_alpha_continuous_from_logsum(
+            data->end-begin, data->logsums[offset], *begin);
+    plfit_i_ks_test_continuous(data->logs + offset, data->logs + (data->end-data->begin),
+            data->last.alpha, data->logs[offset], data->cutoff, &data->last.D);
 
     return data->last.D;
 }
@@ -494,9 +931,11 @@ static int plfit_i_continuous_xmin_opt_linear_scan(
     ptrdiff_t i = 0; /* initialize to work around incorrect warning issued by Clang 9.0 */
     plfit_result_t global_best_result;
     size_t global_best_n;
+    double global_bound;
 
     /* Prepare some variables */
     global_best_n = 0;
+    global_bound = opt_data->cutoff;
     global_best_result.D = DBL_MAX;
     global_best_result.xmin = 0;
     global_best_result.alpha = 0;
@@ -507,9 +946,15 @@ static int plfit_i_continuous_xmin_opt_linear_scan(
      * parallel block contains a critical section that threads will enter
      * one by one and compare their private local_best_result with a
      * global_best that is shared among the threads.
+     *
+     * The best D-score found so far by any of the threads is also shared in
+     * global_bound. A candidate whose KS test exceeds this bound cannot be
+     * the best one, so the KS test is cut short as soon as this happens.
+     * The truncated D is still larger than the D-score of the candidate that
+     * set the bound, so it never wins the final comparison.
      */
 #ifdef _OPENMP
-#pragma omp parallel shared(global_best_result, global_best_n) private(i) firstprivate(opt_data)
+#pragma omp parallel shared(global_best_result, global_best_n, global_bound) private(i) firstprivate(opt_data)
 #endif
     {
         /* These variables are private since they are declared within the
@@ -524,6 +969,7 @@ static int plfit_i_continuous_xmin_opt_linear_scan(
         local_best_result.xmin = 0;
         local_best_result.alpha = 0;
         local_best_result.p = NAN;
+        local_best_result.num_trials = 0;
         local_best_result.L = NAN;
 
         /* The range of the for loop below is divided among the threads.
@@ -534,6 +980,11 @@ static int plfit_i_continuous_xmin_opt_linear_scan(
 #pragma omp for nowait schedule(dynamic,10)
 #endif
         for (i = 0; i < local_opt_data.num_probes-1; i++) {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+            local_opt_data.cutoff = global_bound;
+
             plfit_i_continuous_xmin_opt_evaluate(&local_opt_data, i);
             if (local_opt_data.last.D < local_best_result.D) {
 #ifdef PLFIT_DEBUG
@@ -541,7 +992,21 @@ static int plfit_i_continuous_xmin_opt_linear_scan(
                         local_opt_data.last.xmin, local_opt_data.last.D);
 #endif
                 local_best_result = local_opt_data.last;
-                local_best_n = local_opt_data.end - local_opt_data.probes[i];
+                local_best_n = (local_opt_data.end - local_opt_data.begin) -
+                    plfit_i_continuous_xmin_opt_probe(&local_opt_data, i);
+
+                /* Tighten the shared bound for the other threads */
+#ifdef _OPENMP
+#pragma omp critical (plfit_i_continuous_xmin_bound)
+#endif
+                {
+                    if (local_best_result.D < global_bound) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                        global_bound = local_best_result.D;
+                    }
+                }
             }
         }
 
@@ -570,8 +1035,399 @@ static int plfit_i_continuous_xmin_opt_linear_scan(
     return PLFIT_SUCCESS;
 }
 
-int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_t* options,
-        plfit_result_t* result) {
+/* A probe of the hierarchical xmin search */
+typedef struct {
+    size_t index;         /* index of the probed run */
+    double D;             /* D-score of the probe; a lower bound if it was cut short */
+} plfit_i_xmin_sample_t;
+
+/* A range [lo; hi) of runs that is searched on the next level of the
+ * hierarchical xmin search */
+typedef struct {
+    size_t lo;
+    size_t hi;
+} plfit_i_xmin_range_t;
+
+/* A growing list of ranges of runs */
+typedef struct {
+    plfit_i_xmin_range_t* ranges;
+    size_t size;
+    size_t capacity;
+} plfit_i_xmin_range_list_t;
+
+static int plfit_i_xmin_sample_compare_by_D(const void* a, const void* b) {
+    const plfit_i_xmin_sample_t* sa = (const plfit_i_xmin_sample_t*)a;
+    const plfit_i_xmin_sample_t* sb = (const plfit_i_xmin_sample_t*)b;
+    if (sa->D != sb->D)
+        return sa->D < sb->D ? -1 : 1;
+    return (sa->index > sb->index) - (sa->index < sb->index);
+}
+
+static int plfit_i_xmin_sample_compare_by_index(const void* a, const void* b) {
+    const plfit_i_xmin_sample_t* sa = (const plfit_i_xmin_sample_t*)a;
+    const plfit_i_xmin_sample_t* sb = (const plfit_i_xmin_sample_t*)b;
+    return (sa->index > sb->index) - (sa->index < sb->index);
+}
+
+/* Number of points of the tail where the lower bound of the D-scores of a
+ * range of candidates is evaluated. The bound is relaxed by a small slack
+ * because the vectorized exp() of the KS kernels may differ from exp() in
+ * the last few bits. */
+#define PLFIT_XMIN_BOUND_POINTS 32
+#define PLFIT_XMIN_BOUND_SLACK (16 * DBL_EPSILON)
+
+/**
+ * Returns a lower bound for the D-scores of the candidates in the runs
+ * [lo; hi), where hi must be smaller than the number of runs.
+ *
+ * The elements from the start of run hi on belong to the tail of every
+ * candidate in the range. At such an element, the empirical CDF of a
+ * candidate decreases and the fitted CDF increases with its alpha and
+ * decreases with its xmin, so the distance there is at least the gap between
+ * the ranges that the two CDFs span over all the candidates. The largest gap
+ * over a few such elements bounds every D-score in the range from below.
+ * Candidates that are not positive are never selected, so they are ignored.
+ */
+static double plfit_i_continuous_xmin_opt_lower_bound(
+        const plfit_continuous_xmin_opt_data_t* data, size_t lo, size_t hi) {
+    size_t n = data->end - data->begin, first = 0, last = 0, next, c, j, o;
+    double a, a_min = DBL_MAX, a_max = 0, e_lo, e_hi, f_lo, f_hi, gap, bound = 0;
+    int found = 0;
+
+    for (j = lo; j < hi; j++) {
+        o = plfit_sorted_runs_start(data->runs, j);
+        if (data->begin[o] <= 0)
+            continue;
+
+        a = plfit_i_estimate_alpha_continuous_from_logsum(n - o,
+                data->logsums[o], data->begin[o]) - 1;
+        if (!(a > 0 && a < DBL_MAX)) {
+            /* Rounding errors in the log-sums; do not rely on the bound */
+            return -DBL_MAX;
+        }
+        if (a < a_min)
+            a_min = a;
+        if (a > a_max)
+            a_max = a;
+
+        if (!found)
+            first = o;
+        last = o;
+        found = 1;
+    }
+
+    if (!found)
+        return DBL_MAX;
+
+    next = plfit_sorted_runs_start(data->runs, hi);
+    for (j = 0; j < PLFIT_XMIN_BOUND_POINTS; j++) {
+        c = next + (n - 1 - next) * j / (PLFIT_XMIN_BOUND_POINTS - 1);
+
+        /* The same floating-point operations as in the KS test */
+        e_lo = (c - last) / (double)(n - last);
+        e_hi = (c - first) / (double)(n - first);
+        f_lo = 1 - exp(a_min * (data->logs[last] - data->logs[c]));
+        f_hi = 1 - exp(a_max * (data->logs[first] - data->logs[c]));
+
+        gap = f_lo - e_hi > e_lo - f_hi ? f_lo - e_hi : e_lo - f_hi;
+        if (gap > bound)
+            bound = gap;
+    }
+
+    return bound - PLFIT_XMIN_BOUND_SLACK;
+}
+
+/**
+ * Appends to the list the ranges of runs within [lo; hi) that may contain a
+ * candidate whose D-score is below the threshold. Ranges whose lower bound
+ * is not below the threshold are dropped; the others are split into
+ * \c factor parts until they are at most \c factor runs long. Adjacent
+ * ranges are merged.
+ */
+static int plfit_i_continuous_xmin_opt_collect(
+        const plfit_continuous_xmin_opt_data_t* data, size_t lo, size_t hi,
+        size_t factor, double threshold, plfit_i_xmin_range_list_t* list) {
+    plfit_i_xmin_range_t* ranges;
+    size_t step, j;
+
+    if (plfit_i_continuous_xmin_opt_lower_bound(data, lo, hi) >= threshold)
+        return PLFIT_SUCCESS;
+
+    if (hi - lo > factor) {
+        step = (hi - lo + factor - 1) / factor;
+        for (j = lo; j < hi; j += step) {
+            PLFIT_CHECK(plfit_i_continuous_xmin_opt_collect(data, j,
+                        j + step < hi ? j + step : hi, factor, threshold, list));
+        }
+        return PLFIT_SUCCESS;
+    }
+
+    if (list->size > 0 && list->ranges[list->size - 1].hi == lo) {
+        list->ranges[list->size - 1].hi = hi;
+        return PLFIT_SUCCESS;
+    }
+
+    if (list->size == list->capacity) {
+        ranges = (plfit_i_xmin_range_t*)realloc(list->ranges,
+                sizeof(plfit_i_xmin_range_t) * 2 * list->capacity);
+        if (ranges == 0) {
+            PLFIT_ERROR("cannot allocate memory for the xmin search", PLFIT_ENOMEM);
+        }
+        list->ranges = ranges;
+        list->capacity *= 2;
+    }
+
+    list->ranges[list->size].lo = lo;
+    list->ranges[list->size].hi = hi;
+    list->size++;
+
+    return PLFIT_SUCCESS;
+}
+
+/* Runs a strict linear scan on each of the given ranges of runs */
+static int plfit_i_continuous_xmin_opt_scan_ranges(
+        plfit_continuous_xmin_opt_data_t* opt_data, const plfit_i_xmin_range_t* ranges,
+        size_t num_ranges, plfit_result_t* best_result, size_t* best_n) {
+    plfit_result_t range_result;
+    size_t i, range_n;
+
+    /* The linear scan skips its last probe, hence the extra one */
+    for (i = 0; i < num_ranges; i++) {
+        opt_data->first_probe = ranges[i].lo;
+        opt_data->probe_stride = 1;
+        opt_data->num_probes = ranges[i].hi - ranges[i].lo + 1;
+        opt_data->cutoff = best_result->D;
+        PLFIT_CHECK(plfit_i_continuous_xmin_opt_linear_scan(opt_data, &range_result,
+                    &range_n));
+        if (range_result.D < best_result->D) {
+            *best_result = range_result;
+            *best_n = range_n;
+        }
+    }
+
+    return PLFIT_SUCCESS;
+}
+
+/**
+ * Hierarchical stratified search for the best xmin.
+ *
+ * The first level probes every 16^L-th run, where L is chosen such that there
+ * are at least 16 probes. The \c keep probes with the lowest D-scores are
+ * refined on the next level by probing every 16^(L-1)-th run between their
+ * neighbours. This is repeated until the stride becomes one; the last level
+ * is a linear scan of the remaining ranges. The number of evaluated
+ * candidates is thus O(keep * log(u)) instead of O(u) for u unique elements.
+ * The probes of a level are evaluated in parallel.
+ *
+ * A coarse probe may miss a sharp minimum between its neighbours. Unless
+ * \c tolerance is infinite, the search is therefore followed by a pass over
+ * all the candidates that bounds the D-scores of ranges of runs from below
+ * (see \ref plfit_i_continuous_xmin_opt_lower_bound()) and scans every range
+ * whose bound is more than \c tolerance below the best D-score found. The
+ * D-score of the result is then at most \c tolerance larger than the one of
+ * an exhaustive scan, up to rounding; a zero tolerance gives the exhaustive
+ * result. The bounds take O(u * log(u)) cheap operations.
+ *
+ * \c success is set to zero and nothing else is done if there are too few
+ * unique elements to make the search worthwhile.
+ */
+static int plfit_i_continuous_xmin_opt_hierarchical(
+        plfit_continuous_xmin_opt_data_t* opt_data, size_t num_uniques,
+        size_t keep, double tolerance, plfit_result_t* best_result,
+        size_t* best_n, int* success) {
+    const size_t factor = 16;
+    plfit_i_xmin_sample_t* samples;
+    plfit_i_xmin_range_t *ranges, *new_ranges;
+    plfit_i_xmin_range_list_t list;
+    size_t i, j, k, limit, stride, num_ranges, num_samples, num_kept;
+    ptrdiff_t l = 0;
+    double *top, level_bound;
+    int retval;
+
+    /* The last unique element is never a candidate; see the linear scan */
+    limit = num_uniques > 0 ? num_uniques - 1 : 0;
+    stride = 1;
+    while (limit / (stride * factor) >= factor)
+        stride *= factor;
+
+    *success = 0;
+    if (stride == 1)
+        return PLFIT_SUCCESS;
+
+    if (keep == 0) {
+        PLFIT_ERROR("hierarchical.keep must be positive", PLFIT_EINVAL);
+    }
+    if (!(tolerance >= 0)) {
+        PLFIT_ERROR("hierarchical.tolerance must not be negative", PLFIT_EINVAL);
+    }
+
+    best_result->D = DBL_MAX;
+    *best_n = 0;
+
+    ranges = (plfit_i_xmin_range_t*)malloc(sizeof(plfit_i_xmin_range_t));
+    top = (double*)calloc(keep, sizeof(double));
+    if (ranges == 0 || top == 0) {
+        free(ranges);
+        free(top);
+        PLFIT_ERROR("cannot allocate memory for the xmin search", PLFIT_ENOMEM);
+    }
+    ranges[0].lo = 0;
+    ranges[0].hi = limit;
+    num_ranges = 1;
+
+    for (; stride > 1; stride /= factor) {
+        num_samples = 0;
+        for (i = 0; i < num_ranges; i++)
+            num_samples += (ranges[i].hi - ranges[i].lo + stride - 1) / stride;
+
+        samples = (plfit_i_xmin_sample_t*)malloc(sizeof(plfit_i_xmin_sample_t) *
+                num_samples);
+        if (samples == 0) {
+            free(ranges);
+            free(top);
+            PLFIT_ERROR("cannot allocate memory for the xmin search", PLFIT_ENOMEM);
+        }
+
+        k = 0;
+        for (i = 0; i < num_ranges; i++) {
+            for (j = ranges[i].lo; j < ranges[i].hi; j += stride, k++)
+                samples[k].index = j;
+        }
+
+        /* Evaluate the probes of this level. top[] holds the lowest D-scores
+         * of the level in increasing order; a probe whose D-score exceeds
+         * the keep-th lowest one will not be refined, so its KS test may be
+         * cut short. The threads share top[] and the best result the same
+         * way as in the linear scan. */
+        opt_data->first_probe = 0;
+        opt_data->probe_stride = 1;
+        num_kept = 0;
+        level_bound = DBL_MAX;
+#ifdef _OPENMP
+#pragma omp parallel shared(num_kept, level_bound) private(l)
+#endif
+        {
+            plfit_continuous_xmin_opt_data_t local_opt_data = *opt_data;
+            double D;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,1)
+#endif
+            for (l = 0; l < (ptrdiff_t)num_samples; l++) {
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+                local_opt_data.cutoff = level_bound;
+
+                D = plfit_i_continuous_xmin_opt_evaluate(&local_opt_data,
+                        samples[l].index);
+                samples[l].D = D;
+
+#ifdef _OPENMP
+#pragma omp critical (plfit_i_continuous_xmin_level)
+#endif
+                {
+                    if (D < best_result->D) {
+                        *best_result = local_opt_data.last;
+                        *best_n = (local_opt_data.end - local_opt_data.begin) -
+                            plfit_i_continuous_xmin_opt_probe(&local_opt_data,
+                                    samples[l].index);
+                    }
+
+                    if (num_kept < keep || D < top[keep - 1]) {
+                        size_t pos = num_kept < keep ? num_kept++ : keep - 1;
+                        while (pos > 0 && top[pos - 1] > D) {
+                            top[pos] = top[pos - 1];
+                            pos--;
+                        }
+                        top[pos] = D;
+                        if (num_kept == keep) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                            level_bound = top[keep - 1];
+                        }
+                    }
+                }
+            }
+        }
+
+        /* Select the probes to refine. Probes that were cut short exceed
+         * the final keep-th lowest D-score, so they are never selected. */
+        qsort(samples, num_samples, sizeof(plfit_i_xmin_sample_t),
+                plfit_i_xmin_sample_compare_by_D);
+        num_kept = num_samples < keep ? num_samples : keep;
+        qsort(samples, num_kept, sizeof(plfit_i_xmin_sample_t),
+                plfit_i_xmin_sample_compare_by_index);
+
+        /* The next level searches between the neighbours of each selected
+         * probe; overlapping ranges are merged */
+        new_ranges = (plfit_i_xmin_range_t*)malloc(sizeof(plfit_i_xmin_range_t) *
+                num_kept);
+        if (new_ranges == 0) {
+            free(samples);
+            free(ranges);
+            free(top);
+            PLFIT_ERROR("cannot allocate memory for the xmin search", PLFIT_ENOMEM);
+        }
+
+        num_ranges = 0;
+        for (i = 0; i < num_kept; i++) {
+            j = samples[i].index;
+            k = j >= stride ? j - stride + 1 : 0;
+            if (num_ranges > 0 && new_ranges[num_ranges - 1].hi >= k) {
+                k = new_ranges[num_ranges - 1].lo;
+                num_ranges--;
+            }
+            new_ranges[num_ranges].lo = k;
+            new_ranges[num_ranges].hi = j + stride < limit ? j + stride : limit;
+            num_ranges++;
+        }
+
+        free(samples);
+        free(ranges);
+        ranges = new_ranges;
+    }
+
+    free(top);
+
+    /* The last level is a strict linear scan of the remaining ranges */
+    retval = plfit_i_continuous_xmin_opt_scan_ranges(opt_data, ranges, num_ranges,
+            best_result, best_n);
+    free(ranges);
+    if (retval)
+        return retval;
+
+    /* Scan the ranges that may still hide a candidate that is better than
+     * the best one by more than the tolerance. Lowering the best D-score
+     * later only makes the ranges that were dropped here less promising. */
+    if (tolerance < INFINITY) {
+        list.size = 0;
+        list.capacity = 16;
+        list.ranges = (plfit_i_xmin_range_t*)malloc(sizeof(plfit_i_xmin_range_t) *
+                list.capacity);
+        if (list.ranges == 0) {
+            PLFIT_ERROR("cannot allocate memory for the xmin search", PLFIT_ENOMEM);
+        }
+
+        retval = plfit_i_continuous_xmin_opt_collect(opt_data, 0, limit, factor,
+                best_result->D - tolerance, &list);
+        if (!retval) {
+            retval = plfit_i_continuous_xmin_opt_scan_ranges(opt_data, list.ranges,
+                    list.size, best_result, best_n);
+        }
+        free(list.ranges);
+        if (retval)
+            return retval;
+    }
+
+    *success = 1;
+
+    return PLFIT_SUCCESS;
+}
+
+int plfit_continuous_dataset(plfit_dataset_t* dataset,
+        const plfit_continuous_options_t* options, plfit_result_t* result) {
     gss_parameter_t gss_param;
     plfit_continuous_xmin_opt_data_t opt_data;
     plfit_result_t best_result = {
@@ -579,37 +1435,37 @@ int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_
         /* xmin = */ NAN,
         /* L = */ NAN,
         /* D = */ NAN,
-        /* p = */ NAN
+        /* p = */ NAN,
+        /* num_trials = */ 0
     };
 
     int success;
-    size_t i, best_n, num_uniques = 0;
-    double x, *px, **uniques, **strata;
-    int error_code, retval = PLFIT_SUCCESS;
+    size_t i, best_n, num_uniques = 0, n = dataset->n;
+    double x;
 
     DATA_POINTS_CHECK;
 
-    /* Set up pointers that we will allocate */
-    opt_data.begin = NULL;
-    uniques = NULL;
-    strata = NULL;
-
     /* Sane defaults */
     best_n = n;
     if (!options)
         options = &plfit_continuous_default_options;
 
-    /* Make a copy of xs and sort it */
-    PLFIT_CHECK(plfit_i_copy_and_sort(xs, n, &opt_data.begin));
-    opt_data.end = opt_data.begin + n;
-
-    /* Create an array containing pointers to the unique elements of the input. From
-     * each block of unique elements, we add the pointer to the first one. */
-    uniques = unique_element_pointers(opt_data.begin, opt_data.end, &num_uniques);
-    if (uniques == NULL) {
-        free(opt_data.begin);
-        PLFIT_ERROR("cannot fit continuous power-law", PLFIT_ENOMEM);
-    }
+    /* The first element of each block of identical elements in the sorted
+     * dataset is a candidate for xmin. We also need log(x) for every element,
+     * and the suffix sums of these logarithms, so we can estimate alpha for
+     * any candidate xmin in constant time and evaluate the KS statistic
+     * without calling pow() */
+    PLFIT_CHECK(plfit_i_dataset_get_runs(dataset, &opt_data.runs));
+    PLFIT_CHECK(plfit_i_dataset_prepare_logs(dataset));
+
+    opt_data.begin = dataset->xs;
+    opt_data.end = dataset->xs + n;
+    opt_data.logs = dataset->logs;
+    opt_data.logsums = dataset->logsums;
+    opt_data.cutoff = DBL_MAX;
+    opt_data.first_probe = 0;
+    opt_data.probe_stride = 1;
+    num_uniques = opt_data.runs->num_runs;
 
     /* We will now determine the best xmin that yields the lowest D-score. The
      * 'success' variable will denote whether the search procedure we tried was
@@ -620,15 +1476,13 @@ int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_
         case PLFIT_GSS_OR_LINEAR:
             /* Try golden section search first. */
             if (num_uniques > 5) {
-                opt_data.probes = uniques;
                 opt_data.num_probes = num_uniques;
                 gss_parameter_init(&gss_param);
                 success = (gss(0, opt_data.num_probes-5, &x, 0,
                         plfit_i_continuous_xmin_opt_evaluate,
                         plfit_i_continuous_xmin_opt_progress, &opt_data, &gss_param) == 0);
                 if (success) {
-                    px = opt_data.probes[(int)x];
-                    best_n = opt_data.end-px+1;
+                    best_n = n - plfit_i_continuous_xmin_opt_probe(&opt_data, (size_t)x) + 1;
                     best_result = opt_data.last;
                 }
             }
@@ -643,32 +1497,23 @@ int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_
                 const size_t subdivision_length = 10;
                 size_t num_strata = num_uniques / subdivision_length;
 
-                strata = calloc(num_strata, sizeof(double*));
-                if (strata == NULL) {
-                    free(uniques);
-                    free(opt_data.begin);
-                    PLFIT_ERROR("cannot fit continuous power-law", PLFIT_ENOMEM);
-                }
-
-                for (i = 0; i < num_strata; i++) {
-                    strata[i] = uniques[i * subdivision_length];
-                }
-
-                opt_data.probes = strata;
+                /* The strata are every subdivision_length-th unique element */
+                opt_data.first_probe = 0;
+                opt_data.probe_stride = subdivision_length;
                 opt_data.num_probes = num_strata;
-                error_code = plfit_i_continuous_xmin_opt_linear_scan(&opt_data, &best_result, &best_n);
-                if (error_code != PLFIT_SUCCESS) {
-                    retval = error_code;
-                    goto cleanup;
-                }
+                PLFIT_CHECK(plfit_i_continuous_xmin_opt_linear_scan(
+                    &opt_data, &best_result, &best_n
+                ));
 
                 opt_data.num_probes = 0;
                 for (i = 0; i < num_strata; i++) {
-                    if (*strata[i] == best_result.xmin) {
+                    if (opt_data.begin[plfit_i_continuous_xmin_opt_probe(&opt_data, i)] ==
+                            best_result.xmin) {
                         /* Okay, scan more thoroughly from strata[i-1] to strata[i+1],
                          * which is from uniques[(i-1)*subdivision_length] to
                          * uniques[(i+1)*subdivision_length */
-                        opt_data.probes = uniques + (i > 0 ? (i-1)*subdivision_length : 0);
+                        opt_data.first_probe = (i > 0 ? (i-1)*subdivision_length : 0);
+                        opt_data.probe_stride = 1;
                         opt_data.num_probes = 0;
                         if (i != 0)
                             opt_data.num_probes += subdivision_length;
@@ -678,17 +1523,11 @@ int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_
                     }
                 }
 
-                free(strata); strata = NULL;
-
                 if (opt_data.num_probes > 0) {
                     /* Do a strict linear scan in the subrange determined above */
-                    error_code = plfit_i_continuous_xmin_opt_linear_scan(
+                    PLFIT_CHECK(plfit_i_continuous_xmin_opt_linear_scan(
                         &opt_data, &best_result, &best_n
-                    );
-                    if (error_code) {
-                        retval = error_code;
-                        goto cleanup;
-                    }
+                    ));
                     success = 1;
                 } else {
                     /* This should not happen, but we handle it anyway */
@@ -697,6 +1536,13 @@ int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_
             }
             break;
 
+        case PLFIT_HIERARCHICAL_SAMPLING:
+            PLFIT_CHECK(plfit_i_continuous_xmin_opt_hierarchical(
+                &opt_data, num_uniques, options->hierarchical.keep,
+                options->hierarchical.tolerance, &best_result, &best_n, &success
+            ));
+            break;
+
         default:
             /* Just use the linear search */
             break;
@@ -704,44 +1550,61 @@ int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_
 
     if (!success) {
         /* More advanced search methods failed or were skipped; try linear search */
-        opt_data.probes = uniques;
+        opt_data.cutoff = DBL_MAX;
+        opt_data.first_probe = 0;
+        opt_data.probe_stride = 1;
         opt_data.num_probes = num_uniques;
-        error_code = plfit_i_continuous_xmin_opt_linear_scan(&opt_data, &best_result, &best_n);
-        if (error_code) {
-            retval = error_code;
-            goto cleanup;
-        }
+        PLFIT_CHECK(plfit_i_continuous_xmin_opt_linear_scan(&opt_data, &best_result, &best_n));
         success = 1;
     }
 
-    /* Get rid of the uniques array, we don't need it any more */
-    free(uniques); uniques = NULL;
-
     /* Sort out the result */
     *result = best_result;
     if (options->finite_size_correction)
         plfit_i_perform_finite_size_correction(result, best_n);
 
-    error_code = plfit_log_likelihood_continuous(
-        opt_data.begin + n - best_n, best_n, result->alpha, result->xmin,
-        &result->L
-    );
-    if (error_code) {
-        retval = error_code;
-        goto cleanup;
-    }
+    PLFIT_CHECK(plfit_log_likelihood_continuous_dataset(dataset, result->alpha,
+                result->xmin, &result->L));
+    PLFIT_CHECK(plfit_i_calculate_p_value_continuous(dataset, options, 0, result));
 
-    error_code = plfit_i_calculate_p_value_continuous(opt_data.begin, n, options, 0, result);
-    if (error_code) {
-        retval = error_code;
-        goto cleanup;
-    }
+    return PLFIT_SUCCESS;
+}
+
+int plfit_continuous(const double* xs, size_t n, const plfit_continuous_options_t* options,
+        plfit_result_t* result) {
+    plfit_dataset_t dataset;
+    int retval;
+
+    DATA_POINTS_CHECK;
+
+    /* The xmin scan needs the blocks of identical elements, which are found
+     * while sorting the data */
+    PLFIT_CHECK(plfit_i_dataset_init(&dataset, xs, n, /* with_runs = */ 1));
+    retval = plfit_continuous_dataset(&dataset, options, result);
+    plfit_dataset_destroy(&dataset);
+
+    return retval;
+}
+
+/**
+ * Fits a continuous power-law distribution to a sample that is already sorted
+ * in increasing order, such as the synthetic datasets of the exact p-value
+ * calculation. Only alpha is estimated if \c xmin_fixed is true. Since the
+ * sample is not sorted again, everything but the xmin scan takes linear time.
+ */
+static int plfit_i_continuous_sorted(const double* xs, size_t n, plfit_bool_t xmin_fixed,
+        double xmin, const plfit_continuous_options_t* options, plfit_result_t* result) {
+    plfit_dataset_t dataset;
+    int retval;
 
-cleanup:
-    /* It is safe to call free() on NULL */
-    free(strata);
-    free(uniques);
-    free(opt_data.begin);
+    if (xmin_fixed) {
+        PLFIT_CHECK(plfit_i_dataset_init_tail(&dataset, xs, n, xmin, /* sorted = */ 1));
+        retval = plfit_estimate_alpha_continuous_dataset(&dataset, xmin, options, result);
+    } else {
+        PLFIT_CHECK(plfit_i_dataset_init_sorted(&dataset, xs, n));
+        retval = plfit_continuous_dataset(&dataset, options, result);
+    }
+    plfit_dataset_destroy(&dataset);
 
     return retval;
 }
@@ -752,15 +1615,10 @@ typedef struct {
     size_t m;
     double logsum;
     double xmin;
+    double alpha_offset;   /**< alpha at the origin of the L-BFGS variable */
+    double alpha_scale;    /**< change of alpha per unit of the L-BFGS variable */
 } plfit_i_estimate_alpha_discrete_data_t;
 
-static double plfit_i_logsum_discrete(const double* begin, const double* end, double xmin) {
-    double logsum = 0.0;
-    for (; begin != end; begin++)
-        logsum += log(*begin);
-    return logsum;
-}
-
 static void plfit_i_logsum_less_than_discrete(const double* begin, const double* end, double xmin,
         double* logsum, size_t* m) {
     double result = 0.0;
@@ -788,14 +1646,16 @@ static lbfgsfloatval_t plfit_i_estimate_alpha_discrete_lbfgs_evaluate(
     double huge = 1e10;     /* pseudo-infinity; apparently DBL_MAX does not work */
     double lnhzeta_x=NAN;
     double lnhzeta_deriv_x=NAN;
+    double alpha;
 
     data = (plfit_i_estimate_alpha_discrete_data_t*)instance;
+    alpha = data->alpha_offset + data->alpha_scale * x[0];
 
 #ifdef PLFIT_DEBUG
-    printf("- Evaluating at %.4f (step = %.4f, xmin = %.4f)\n", *x, step, data->xmin);
+    printf("- Evaluating at %.4f (step = %.4f, xmin = %.4f)\n", alpha, step, data->xmin);
 #endif
 
-    if (isnan(*x)) {
+    if (isnan(alpha)) {
         g[0] = huge;
         return huge;
     }
@@ -805,20 +1665,21 @@ static lbfgsfloatval_t plfit_i_estimate_alpha_discrete_lbfgs_evaluate(
         dx = 0.001;
     else if (dx < -0.001)
         dx = -0.001;
+    dx *= data->alpha_scale;
 
-    /* Is x[0] in its valid range? */
-    if (x[0] <= 1.0) {
+    /* Is alpha in its valid range? */
+    if (alpha <= 1.0) {
         /* The Hurwitz zeta function is infinite in this case */
         g[0] = (dx > 0) ? -huge : huge;
         return huge;
     }
-    if (x[0] + dx <= 1.0) {
+    if (alpha + dx <= 1.0) {
         g[0] = huge;
-        result = x[0] * data->logsum + data->m * hsl_sf_lnhzeta(x[0], data->xmin);
+        result = alpha * data->logsum + data->m * hsl_sf_lnhzeta(alpha, data->xmin);
     } else {
-        hsl_sf_lnhzeta_deriv_tuple(x[0], data->xmin, &lnhzeta_x, &lnhzeta_deriv_x);
-        g[0] = data->logsum + data->m * lnhzeta_deriv_x;
-        result = x[0] * data->logsum + data->m * lnhzeta_x;
+        hsl_sf_lnhzeta_deriv_tuple(alpha, data->xmin, &lnhzeta_x, &lnhzeta_deriv_x);
+        g[0] = data->alpha_scale * (data->logsum + data->m * lnhzeta_deriv_x);
+        result = alpha * data->logsum + data->m * lnhzeta_x;
     }
 
 #ifdef PLFIT_DEBUG
@@ -837,12 +1698,15 @@ static int plfit_i_estimate_alpha_discrete_lbfgs_progress(void* instance,
     return 0;
 }
 
-static int plfit_i_estimate_alpha_discrete_linear_scan(const double* xs, size_t n,
-        double xmin, double* alpha, const plfit_discrete_options_t* options,
-        plfit_bool_t sorted) {
+/* Number of grid points of the linear scan for alpha that are evaluated at
+ * once */
+#define PLFIT_LINEAR_SCAN_CHUNK 256
+
+static int plfit_i_estimate_alpha_discrete_linear_scan(size_t m, double logsum,
+        double xmin, double* alpha, const plfit_discrete_options_t* options) {
+    double alphas[PLFIT_LINEAR_SCAN_CHUNK], lnhzetas[PLFIT_LINEAR_SCAN_CHUNK];
     double curr_alpha, best_alpha, L, L_max;
-    double logsum;
-    size_t m;
+    size_t i, k;
 
     XMIN_CHECK_ONE;
     if (options->alpha.min <= 1.0) {
@@ -855,20 +1719,24 @@ static int plfit_i_estimate_alpha_discrete_linear_scan(const double* xs, size_t
         PLFIT_ERROR("alpha.step must be positive", PLFIT_EINVAL);
     }
 
-    if (sorted) {
-        logsum = plfit_i_logsum_discrete(xs, xs+n, xmin);
-        m = n;
-    } else {
-        plfit_i_logsum_less_than_discrete(xs, xs+n, xmin, &logsum, &m);
-    }
-
+    /* The grid is evaluated in chunks so that the terms of lnhzeta() that
+     * depend on xmin only are shared among the grid points of a chunk */
     best_alpha = options->alpha.min; L_max = -DBL_MAX;
-    for (curr_alpha = options->alpha.min; curr_alpha <= options->alpha.max;
-            curr_alpha += options->alpha.step) {
-        L = -curr_alpha * logsum - m * hsl_sf_lnhzeta(curr_alpha, xmin);
-        if (L > L_max) {
-            L_max = L;
-            best_alpha = curr_alpha;
+    curr_alpha = options->alpha.min;
+    while (curr_alpha <= options->alpha.max) {
+        for (k = 0; k < PLFIT_LINEAR_SCAN_CHUNK && curr_alpha <= options->alpha.max;
+                k++, curr_alpha += options->alpha.step) {
+            alphas[k] = curr_alpha;
+        }
+
+        PLFIT_CHECK(hsl_sf_lnhzeta_multi(alphas, k, xmin, lnhzetas));
+
+        for (i = 0; i < k; i++) {
+            L = -alphas[i] * logsum - m * lnhzetas[i];
+            if (L > L_max) {
+                L_max = L;
+                best_alpha = alphas[i];
+            }
         }
     }
 
@@ -877,12 +1745,17 @@ static int plfit_i_estimate_alpha_discrete_linear_scan(const double* xs, size_t
     return PLFIT_SUCCESS;
 }
 
-static int plfit_i_estimate_alpha_discrete_lbfgs(const double* xs, size_t n, double xmin,
-        double* alpha, const plfit_discrete_options_t* options, plfit_bool_t sorted) {
+/* Lower bound of the step of a warm-started L-BFGS run, relative to the
+ * starting point */
+#define PLFIT_WARM_START_MIN_STEP 1e-6
+
+static int plfit_i_estimate_alpha_discrete_lbfgs(size_t m, double logsum, double xmin,
+        double alpha_start, double alpha_step, double* alpha,
+        const plfit_discrete_options_t* options) {
     lbfgs_parameter_t param;
     lbfgsfloatval_t* variables;
     plfit_i_estimate_alpha_discrete_data_t data;
-    int ret;
+    int ret, warm;
 
     XMIN_CHECK_ONE;
 
@@ -892,34 +1765,62 @@ static int plfit_i_estimate_alpha_discrete_lbfgs(const double* xs, size_t n, dou
 
     /* Set up context for optimization */
     data.xmin = xmin;
-    if (sorted) {
-        data.logsum = plfit_i_logsum_discrete(xs, xs+n, xmin);
-        data.m = n;
-    } else {
-        plfit_i_logsum_less_than_discrete(xs, xs+n, xmin, &data.logsum, &data.m);
-    }
+    data.logsum = logsum;
+    data.m = m;
+    data.alpha_offset = 0;
+    data.alpha_scale = 1;
 
     /* Allocate space for the single alpha variable */
     variables = lbfgs_malloc(1);
     variables[0] = 3.0;       /* initial guess */
 
-    /* Optimization */
-    ret = lbfgs(1, variables, /* ptr_fx = */ 0,
-            plfit_i_estimate_alpha_discrete_lbfgs_evaluate,
-            plfit_i_estimate_alpha_discrete_lbfgs_progress,
-            &data, &param);
+    /* When warm-started, optimize over the offset from alpha_start in units
+     * of alpha_step instead. The first line search of L-BFGS tries a unit
+     * step, which would overshoot the optimum by far if measured in alpha
+     * itself. The gradient tolerance is rescaled so the optimization stops
+     * at the same accuracy in alpha as a cold start as long as the optimum
+     * is within one step from alpha_start. */
+    warm = isfinite(alpha_start) && alpha_start > 1 && alpha_step >= 0;
+    if (warm) {
+        data.alpha_offset = alpha_start;
+        data.alpha_scale = fmax(alpha_step, PLFIT_WARM_START_MIN_STEP * alpha_start);
+        param.epsilon *= data.alpha_scale * alpha_start;
+        variables[0] = 0;
+    }
+
+    while (1) {
+        /* Optimization */
+        ret = lbfgs(1, variables, /* ptr_fx = */ 0,
+                plfit_i_estimate_alpha_discrete_lbfgs_evaluate,
+                plfit_i_estimate_alpha_discrete_lbfgs_progress,
+                &data, &param);
+
+        if (ret < 0 &&
+            ret != LBFGSERR_ROUNDING_ERROR &&
+            ret != LBFGSERR_MAXIMUMLINESEARCH &&
+            ret != LBFGSERR_MINIMUMSTEP &&
+            ret != LBFGSERR_CANCELED) {
+            char buf[4096];
+            snprintf(buf, 4096, "L-BFGS optimization signaled an error (error code = %d)", ret);
+            lbfgs_free(variables);
+            PLFIT_ERROR(buf, PLFIT_FAILURE);
+        }
+
+        if (!warm || fabs(variables[0]) <= 1)
+            break;
 
-    if (ret < 0 &&
-        ret != LBFGSERR_ROUNDING_ERROR &&
-        ret != LBFGSERR_MAXIMUMLINESEARCH &&
-        ret != LBFGSERR_MINIMUMSTEP &&
-        ret != LBFGSERR_CANCELED) {
-        char buf[4096];
-        snprintf(buf, 4096, "L-BFGS optimization signaled an error (error code = %d)", ret);
-        lbfgs_free(variables);
-        PLFIT_ERROR(buf, PLFIT_FAILURE);
+        /* The optimum was farther than expected, so the rescaled tolerance
+         * may have stopped the optimization too early. Continue from here
+         * without the rescaling. */
+        variables[0] = data.alpha_offset + data.alpha_scale * variables[0];
+        data.alpha_offset = 0;
+        data.alpha_scale = 1;
+        lbfgs_parameter_init(&param);
+        param.max_iterations = 0;
+        warm = 0;
     }
-    *alpha = variables[0];
+
+    *alpha = data.alpha_offset + data.alpha_scale * variables[0];
 
     /* Deallocate the variable array */
     lbfgs_free(variables);
@@ -927,81 +1828,382 @@ static int plfit_i_estimate_alpha_discrete_lbfgs(const double* xs, size_t n, dou
     return PLFIT_SUCCESS;
 }
 
-static int plfit_i_estimate_alpha_discrete_fast(const double* xs, size_t n, double xmin,
-        double* alpha, const plfit_discrete_options_t* options, plfit_bool_t sorted) {
-    plfit_continuous_options_t cont_options;
+/* Iteration limit and relative tolerance of the safeguarded Newton solver */
+#define PLFIT_NEWTON_MAX_ITERATIONS 100
+#define PLFIT_NEWTON_TOLERANCE 1e-10
+
+/**
+ * Calculates the first and second derivative of the negative log-likelihood
+ * of a discrete power-law, alpha * logsum + m * lnhzeta(alpha, xmin), with
+ * respect to alpha.
+ */
+static void plfit_i_discrete_nll_derivs(size_t m, double logsum, double xmin,
+        double alpha, double* d1, double* d2) {
+    double lnhzeta, lnhzeta_deriv, h;
+
+    hsl_sf_lnhzeta_deriv_tuple(alpha, xmin, &lnhzeta, &lnhzeta_deriv);
+    *d1 = logsum + m * lnhzeta_deriv;
+
+    /* (ln zeta)'' = zeta'' / zeta - (zeta' / zeta)^2. zeta'' is not available
+     * in the log domain, so we fall back to a central difference of
+     * (ln zeta)' where zeta itself would underflow */
+    if (-alpha * log(xmin) > log(DBL_MIN) + 1) {
+        *d2 = m * (hsl_sf_hzeta_deriv2(alpha, xmin) * exp(-lnhzeta) -
+                lnhzeta_deriv * lnhzeta_deriv);
+    } else {
+        h = 1e-5 * alpha;
+        *d2 = m * (hsl_sf_lnhzeta_deriv(alpha + h, xmin) -
+                hsl_sf_lnhzeta_deriv(alpha - h, xmin)) / (2 * h);
+    }
+}
+
+static int plfit_i_estimate_alpha_discrete_newton(size_t m, double logsum, double xmin,
+        double* alpha) {
+    double x, next, lo, hi, d1, d2;
+    int i;
+
+    XMIN_CHECK_ONE;
+
+    if (m == 0) {
+        PLFIT_ERROR("no data point was larger than xmin", PLFIT_EINVAL);
+    }
+
+    /* The negative log-likelihood is convex in alpha, and its derivative goes
+     * from minus infinity at alpha = 1 to logsum - m * log(xmin) >= 0, so the
+     * root of the derivative can always be bracketed from below by 1. The
+     * pretend-continuous estimate is a good starting point. */
+    x = plfit_i_estimate_alpha_continuous_from_logsum(m, logsum, xmin-0.5);
+    lo = 1;
+    hi = INFINITY;
+
+    for (i = 0; i < PLFIT_NEWTON_MAX_ITERATIONS; i++) {
+        plfit_i_discrete_nll_derivs(m, logsum, xmin, x, &d1, &d2);
+
+        /* Update the bracket */
+        if (d1 > 0) {
+            hi = x;
+        } else {
+            lo = x;
+        }
+
+        /* The derivative only approaches zero without crossing it if every
+         * sample is equal to xmin; we stop at a large alpha then */
+        if (fabs(d1) <= PLFIT_NEWTON_TOLERANCE * m)
+            break;
+
+        /* Take a Newton step if it stays within the bracket; otherwise bisect
+         * the bracket, or extend it if it has no upper end yet */
+        next = x - d1 / d2;
+        if (!(d2 > 0) || !(next > lo && next < hi)) {
+            next = isfinite(hi) ? (lo + hi) / 2 : 2 * x;
+        }
+
+        if (fabs(next - x) <= PLFIT_NEWTON_TOLERANCE * x) {
+            x = next;
+            break;
+        }
+        x = next;
+    }
+
+    if (i == PLFIT_NEWTON_MAX_ITERATIONS) {
+        PLFIT_ERROR("Newton's method did not converge for alpha", PLFIT_EMAXITER);
+    }
+
+    *alpha = x;
+
+    return PLFIT_SUCCESS;
+}
+
+static int plfit_i_estimate_alpha_discrete_fast(size_t m, double logsum, double xmin,
+        double* alpha) {
+    XMIN_CHECK_ONE;
+
+    if (m == 0) {
+        PLFIT_ERROR("no data point was larger than xmin", PLFIT_EINVAL);
+    }
+
+    /* Pretend that the data is continuous and starts at xmin-0.5 */
+    *alpha = plfit_i_estimate_alpha_continuous_from_logsum(m, logsum, xmin-0.5);
+
+    return PLFIT_SUCCESS;
+}
+
+/**
+ * Estimates alpha for a discrete power-law with a given xmin from the number
+ * of samples in the tail and the sum of their logarithms, using the method
+ * given in the options. This lets the xmin scan feed every candidate from a
+ * table of suffix log-sums in constant time.
+ *
+ * \c alpha_start and \c alpha_step let L-BFGS warm-start from the estimate
+ * of a neighbouring xmin candidate, expecting the optimum within about
+ * \c alpha_step of it; pass \c NAN for a cold start. Newton's method starts
+ * from the pretend-continuous estimate instead, which is closer to the
+ * optimum than the estimate of the previous candidate in practice.
+ */
+static int plfit_i_estimate_alpha_discrete_from_logsum(size_t m, double logsum,
+        double xmin, double alpha_start, double alpha_step, double* alpha,
+        const plfit_discrete_options_t* options) {
+    switch (options->alpha_method) {
+        case PLFIT_LBFGS:
+            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_lbfgs(m, logsum, xmin,
+                        alpha_start, alpha_step, alpha, options));
+            break;
+
+        case PLFIT_LINEAR_SCAN:
+            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_linear_scan(m, logsum, xmin,
+                        alpha, options));
+            break;
+
+        case PLFIT_PRETEND_CONTINUOUS:
+            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_fast(m, logsum, xmin,
+                        alpha));
+            break;
+
+        case PLFIT_NEWTON:
+            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_newton(m, logsum, xmin,
+                        alpha));
+            break;
+
+        default:
+            PLFIT_ERROR("unknown optimization method specified", PLFIT_EINVAL);
+    }
+
+    return PLFIT_SUCCESS;
+}
+
+/* Block sizes of the block-bounded discrete KS test; see
+ * plfit_i_ks_test_discrete(). lnhzeta() is not guaranteed to be monotone in
+ * the last few bits, so the bound of a block is relaxed by a small slack. */
+#define PLFIT_KS_DISCRETE_BLOCK_SIZE 32
+#define PLFIT_KS_DISCRETE_BLOCK_MIN_SIZE 4
+#define PLFIT_KS_DISCRETE_BLOCK_SLACK 1e-12
+
+/* The CDF of the discrete KS test is accumulated term by term from a nearby
+ * value where it is already known if the two values are at most this many
+ * integers apart, and evaluated directly with lnhzeta() otherwise */
+#define PLFIT_KS_DISCRETE_MAX_GAP 4
+
+/* The CDF is evaluated directly after this many accumulations in a row so
+ * the rounding errors of the partial sums stay well below the slack above */
+#define PLFIT_KS_DISCRETE_ANCHOR_INTERVAL 64
+
+/**
+ * Returns the CDF of a discrete power-law at x minus one, i.e.
+ * expm1(lnhzeta(alpha, x) - lnhzeta(alpha, xmin)), given the same quantity
+ * at an anchor x0 < x.
+ *
+ * Since hzeta(alpha, x) = hzeta(alpha, x0) - sum_{k=x0}^{x-1} k^(-alpha) if
+ * x - x0 is an integer, the result is obtained from the anchor with a few
+ * power terms if the gap is small, which is considerably cheaper than
+ * evaluating the Hurwitz zeta function. The terms are scaled by
+ * hzeta(alpha, xmin) in the log domain so they do not underflow. Pass \c NAN
+ * as the anchor to evaluate the CDF directly.
+ */
+static double plfit_i_ks_discrete_cdf(double alpha, double lnhzeta, double x,
+        double x0, double cdf0) {
+    double gap = x - x0;
+
+    if (gap == 0)
+        return cdf0;
+
+    if (gap > 0 && gap <= PLFIT_KS_DISCRETE_MAX_GAP && gap == floor(gap)) {
+        for (; x0 < x; x0++) {
+            cdf0 -= exp(-alpha * log(x0) - lnhzeta);
+        }
+        return cdf0;
+    }
+
+    /* Re the next line: this used to be the following:
+     *
+     * 1 - hzeta(alpha, x) / hzeta(alpha, xmin)
+     *
+     * However, using the Hurwitz zeta directly sometimes yields
+     * underflows (see Github pull request #17 and related issues).
+     * hzeta(alpha, x) / hzeta(alpha, xmin) can be replaced with
+     * exp(lnhzeta(alpha, x) - lnhzeta(alpha, xmin)), but then
+     * we have 1 - exp(something), which is better to calculate
+     * with a dedicated expm1() function.
+     */
+    return expm1(hsl_sf_lnhzeta(alpha, x) - lnhzeta);
+}
+
+typedef struct {
+    const double* xs;     /**< The sorted sample */
+    double dn;            /**< Number of elements in the sample */
+    double alpha;         /**< The exponent of the fitted power-law */
+    double lnhzeta;       /**< lnhzeta(alpha, xmin) */
+    double cutoff;        /**< The test stops once the maximum exceeds this */
+    double result;        /**< The largest distance found so far */
+    double last_x;        /**< The last element whose CDF was calculated */
+    double last_cdf;      /**< The CDF term of last_x */
+} plfit_i_ks_discrete_blocked_t;
+
+/* Returns the CDF of the fitted distribution minus one for the element at
+ * index i, given the same quantity at the element at index a < i as an
+ * anchor. Pass an anchor index >= i to evaluate the CDF directly. */
+static double plfit_i_ks_discrete_blocked_cdf(plfit_i_ks_discrete_blocked_t* state,
+        size_t i, size_t a, double cdf_a) {
+    double x = state->xs[i];
+    if (x != state->last_x) {
+        state->last_x = x;
+        state->last_cdf = plfit_i_ks_discrete_cdf(state->alpha, state->lnhzeta, x,
+                a < i ? state->xs[a] : NAN, cdf_a);
+    }
+    return state->last_cdf;
+}
+
+/* Updates the running maximum with the distance at index i if a block of
+ * identical elements starts there. Returns nonzero if the cutoff was
+ * exceeded. */
+static int plfit_i_ks_discrete_blocked_update(plfit_i_ks_discrete_blocked_t* state,
+        size_t i, double cdf) {
+    double d;
 
-    if (!options)
-        options = &plfit_discrete_default_options;
+    if (i > 0 && state->xs[i-1] == state->xs[i])
+        return 0;
 
-    plfit_continuous_options_init(&cont_options);
-    cont_options.finite_size_correction = options->finite_size_correction;
+    d = fabs(cdf + i / state->dn);
+    if (d > state->result) {
+        state->result = d;
+        return state->result > state->cutoff;
+    }
 
-    XMIN_CHECK_ONE;
+    return 0;
+}
 
-    if (sorted) {
-        return plfit_i_estimate_alpha_continuous_sorted(xs, n, xmin-0.5, alpha);
-    } else {
-        return plfit_i_estimate_alpha_continuous(xs, n, xmin-0.5, alpha);
+/* Finds the largest distance strictly between indices a and b, given the
+ * CDF terms at a and b. Returns nonzero if the cutoff was exceeded. */
+static int plfit_i_ks_discrete_blocked_expand(plfit_i_ks_discrete_blocked_t* state,
+        size_t a, size_t b, double cdf_a, double cdf_b) {
+    double bound, lo, hi, cdf_mid;
+    size_t i, mid;
+
+    /* There is nothing to do if the block contains a single value */
+    if (b - a < 2 || state->xs[a] == state->xs[b])
+        return 0;
+
+    /* The CDF term is decreasing and the empirical CDF is increasing within
+     * the block, so their sum is between the two values below */
+    lo = fabs(cdf_b + a / state->dn);
+    hi = fabs(cdf_a + b / state->dn);
+    bound = lo > hi ? lo : hi;
+    if (bound + PLFIT_KS_DISCRETE_BLOCK_SLACK <= state->result)
+        return 0;
+
+    if (b - a <= PLFIT_KS_DISCRETE_BLOCK_MIN_SIZE) {
+        for (i = a + 1; i < b; i++) {
+            if (state->xs[i] == state->xs[i-1])
+                continue;
+            cdf_mid = state->xs[i] == state->xs[b] ? cdf_b :
+                plfit_i_ks_discrete_blocked_cdf(state, i, a, cdf_a);
+            if (plfit_i_ks_discrete_blocked_update(state, i, cdf_mid))
+                return 1;
+            a = i;
+            cdf_a = cdf_mid;
+        }
+        return 0;
     }
-}
 
-static int plfit_i_estimate_alpha_discrete(const double* xs, size_t n, double xmin,
-        double* alpha, const plfit_discrete_options_t* options,
-        plfit_bool_t sorted) {
-    switch (options->alpha_method) {
-        case PLFIT_LBFGS:
-            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_lbfgs(xs, n, xmin, alpha,
-                        options, sorted));
-            break;
+    /* The CDF term at the midpoint is known if it belongs to the same block
+     * of identical elements as one of the endpoints */
+    mid = a + (b - a) / 2;
+    if (state->xs[mid] == state->xs[a])
+        cdf_mid = cdf_a;
+    else if (state->xs[mid] == state->xs[b])
+        cdf_mid = cdf_b;
+    else
+        cdf_mid = plfit_i_ks_discrete_blocked_cdf(state, mid, a, cdf_a);
+    return plfit_i_ks_discrete_blocked_update(state, mid, cdf_mid) ||
+        plfit_i_ks_discrete_blocked_expand(state, a, mid, cdf_a, cdf_mid) ||
+        plfit_i_ks_discrete_blocked_expand(state, mid, b, cdf_mid, cdf_b);
+}
 
-        case PLFIT_LINEAR_SCAN:
-            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_linear_scan(xs, n, xmin,
-                        alpha, options, sorted));
-            break;
+/* Block-bounded variant of plfit_i_ks_test_discrete(). The CDF is evaluated
+ * at the endpoints of fixed-size blocks first, and then only those blocks are
+ * bisected where the distance may exceed the largest one seen so far. The
+ * result is the same as the one of the full scan. */
+static double plfit_i_ks_test_discrete_blocked(const double* xs, size_t n,
+        double alpha, double lnhzeta, double cutoff, double* grid) {
+    plfit_i_ks_discrete_blocked_t state;
+    size_t a, b, i, num_blocks;
+
+    state.xs = xs;
+    state.dn = n;
+    state.alpha = alpha;
+    state.lnhzeta = lnhzeta;
+    state.cutoff = cutoff;
+    state.result = 0;
+    state.last_x = NAN;
+    state.last_cdf = NAN;
+
+    /* Evaluate the endpoints of the blocks first to get a good lower bound
+     * for the maximum, then expand the blocks that may still exceed it. Each
+     * endpoint is anchored to the previous one, except for every
+     * PLFIT_KS_DISCRETE_ANCHOR_INTERVAL-th one */
+    num_blocks = (n - 1 + PLFIT_KS_DISCRETE_BLOCK_SIZE - 1) / PLFIT_KS_DISCRETE_BLOCK_SIZE;
+    for (i = 0, b = 0; i <= num_blocks; i++) {
+        a = i < num_blocks ? i * PLFIT_KS_DISCRETE_BLOCK_SIZE : n - 1;
+        grid[i] = plfit_i_ks_discrete_blocked_cdf(&state, a,
+                i % PLFIT_KS_DISCRETE_ANCHOR_INTERVAL ? b : a, i > 0 ? grid[i-1] : 0);
+        if (plfit_i_ks_discrete_blocked_update(&state, a, grid[i]))
+            return state.result;
+        b = a;
+    }
 
-        case PLFIT_PRETEND_CONTINUOUS:
-            PLFIT_CHECK(plfit_i_estimate_alpha_discrete_fast(xs, n, xmin,
-                        alpha, options, sorted));
+    for (i = 0; i < num_blocks; i++) {
+        a = i * PLFIT_KS_DISCRETE_BLOCK_SIZE;
+        b = i + 1 < num_blocks ? a + PLFIT_KS_DISCRETE_BLOCK_SIZE : n - 1;
+        if (plfit_i_ks_discrete_blocked_expand(&state, a, b, grid[i], grid[i + 1]))
             break;
-
-        default:
-            PLFIT_ERROR("unknown optimization method specified", PLFIT_EINVAL);
     }
 
-    return PLFIT_SUCCESS;
+    return state.result;
 }
 
 static int plfit_i_ks_test_discrete(const double* xs, const double* xs_end, const double alpha,
-        const double xmin, double* D) {
+        const double xmin, const double cutoff, double* D) {
     /* Assumption: xs is sorted and cut off at xmin so the first element is
-     * always larger than or equal to xmin. */
-    double result = 0, n, lnhzeta, x;
+     * always larger than or equal to xmin. Long samples are split into
+     * blocks, and blocks whose endpoints show that they cannot contain the
+     * maximum are skipped. The test stops as soon as the running maximum
+     * exceeds the cutoff; the value of D is then larger than the cutoff but
+     * it is not necessarily the exact KS statistic. */
+    double result = 0, n, lnhzeta, x, x0 = xmin, cdf = 0;
+    size_t num_distinct = 1;
     int m = 0;
 
     n = xs_end - xs;
     lnhzeta = hsl_sf_lnhzeta(alpha, xmin);
 
+    if (n >= 4 * PLFIT_KS_DISCRETE_BLOCK_SIZE) {
+        double* grid = (double*)malloc(sizeof(double) *
+                ((size_t)n / PLFIT_KS_DISCRETE_BLOCK_SIZE + 2));
+        if (grid != 0) {
+            *D = plfit_i_ks_test_discrete_blocked(xs, n, alpha, lnhzeta, cutoff, grid);
+            free(grid);
+            return PLFIT_SUCCESS;
+        }
+        /* Fall back to the full scan if there is not enough memory */
+    }
+
+    /* Each distinct value is anchored to the previous one (or to xmin, where
+     * the CDF is zero), except for every PLFIT_KS_DISCRETE_ANCHOR_INTERVAL-th
+     * one */
     while (xs < xs_end) {
         double d;
 
         x = *xs;
+        cdf = plfit_i_ks_discrete_cdf(alpha, lnhzeta, x,
+                num_distinct % PLFIT_KS_DISCRETE_ANCHOR_INTERVAL ? x0 : NAN, cdf);
+        x0 = x;
+        num_distinct++;
 
-        /* Re the next line: this used to be the following:
-         *
-         * fabs( 1 - hzeta(alpha, x) / hzeta(alpha, xmin) - m / n)
-         *
-         * However, using the Hurwitz zeta directly sometimes yields
-         * underflows (see Github pull request #17 and related issues).
-         * hzeta(alpha, x) / hzeta(alpha, xmin) can be replaced with
-         * exp(lnhzeta(alpha, x) - lnhzeta(alpha, xmin)), but then
-         * we have 1 - exp(something), which is better to calculate
-         * with a dedicated expm1() function.
-         */
-        d = fabs( expm1( hsl_sf_lnhzeta(alpha, x) - lnhzeta ) + m / n);
-
-        if (d > result)
+        d = fabs(cdf + m / n);
+        if (d > result) {
             result = d;
+            if (result > cutoff)
+                break;
+        }
 
         do {
             xs++; m++;
@@ -1013,104 +2215,65 @@ static int plfit_i_ks_test_discrete(const double* xs, const double* xs_end, cons
     return PLFIT_SUCCESS;
 }
 
-static int plfit_i_calculate_p_value_discrete(const double* xs, size_t n,
+/* Parameters of a trial of the exact p-value calculation for discrete data */
+typedef struct {
+    const double* xs_head;  /**< Elements of the dataset smaller than xmin, sorted */
+    size_t num_smaller;     /**< Number of elements smaller than xmin */
+    size_t n;               /**< Number of elements in the dataset */
+    plfit_bool_t xmin_fixed; /**< Whether the synthetic fits keep xmin fixed */
+    const plfit_result_t* result; /**< The fit of the original dataset */
+    plfit_discrete_options_t options; /**< Options of the synthetic fits */
+} plfit_i_p_value_trial_discrete_t;
+
+static int plfit_i_p_value_trial_discrete(const void* data, plfit_mt_rng_t* rng,
+        plfit_rbinom_state_t* binom_state, double* ys, double* D) {
+    const plfit_i_p_value_trial_discrete_t* trial = (const plfit_i_p_value_trial_discrete_t*)data;
+    plfit_result_t result_synthetic;
+
+    PLFIT_CHECK(plfit_i_resample_discrete_sorted(trial->xs_head, trial->num_smaller,
+                trial->n, trial->result->alpha, trial->result->xmin, trial->n,
+                binom_state, rng, ys));
+    PLFIT_CHECK(plfit_i_discrete_sorted(ys, trial->n, trial->xmin_fixed,
+                trial->result->xmin, &trial->options, &result_synthetic));
+    *D = result_synthetic.D;
+
+    return PLFIT_SUCCESS;
+}
+
+static int plfit_i_calculate_p_value_discrete(const plfit_dataset_t* dataset,
         const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
         plfit_result_t *result) {
-    long int num_trials;
-    long int successes = 0;
-    double *xs_head;
-    size_t num_smaller;
-    plfit_discrete_options_t options_no_p_value = *options;
-    int retval = PLFIT_SUCCESS;
+    plfit_i_p_value_trial_discrete_t trial;
+    size_t n = dataset->n, num_smaller;
 
     if (options->p_value_method == PLFIT_P_VALUE_SKIP) {
         /* skipping p-value calculation */
         result->p = NAN;
+        result->num_trials = 0;
         return PLFIT_SUCCESS;
     }
 
+    /* The dataset is sorted so the elements smaller than xmin form its head */
+    num_smaller = plfit_i_dataset_tail(dataset, result->xmin);
+
     if (options->p_value_method == PLFIT_P_VALUE_APPROXIMATE) {
         /* p-value approximation; most likely an upper bound */
-        num_smaller = count_smaller(xs, xs + n, result->xmin);
         result->p = plfit_ks_test_one_sample_p(result->D, n - num_smaller);
+        result->num_trials = 0;
         return PLFIT_SUCCESS;
     }
 
-    options_no_p_value.p_value_method = PLFIT_P_VALUE_SKIP;
-    num_trials = (long int)(0.25 / options->p_value_precision / options->p_value_precision);
-    if (num_trials <= 0) {
-        PLFIT_ERROR("invalid p-value precision", PLFIT_EINVAL);
-    }
-
-    /* Extract the head of xs that contains elements smaller than xmin */
-    xs_head = extract_smaller(xs, xs+n, result->xmin, &num_smaller);
-    if (xs_head == 0)
-        PLFIT_ERROR("cannot calculate exact p-value", PLFIT_ENOMEM);
-
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-    {
-        /* Parallel section starts here. If we are compiling using OpenMP, each
-         * thread will use its own RNG that is seeded from the master RNG. If
-         * we are compiling without OpenMP, there is only one thread and it uses
-         * the master RNG. This section must be critical to ensure that only one
-         * thread is using the master RNG at the same time. */
-#ifdef _OPENMP
-        plfit_mt_rng_t private_rng;
-#endif
-        plfit_mt_rng_t *p_rng;
-        double *ys;
-        long int i;
-        plfit_result_t result_synthetic;
-
-#ifdef _OPENMP
-#pragma omp critical
-        {
-            p_rng = &private_rng;
-            plfit_mt_init_from_rng(p_rng, options->rng);
-        }
-#else
-        p_rng = options->rng;
-#endif
-
-        /* Allocate memory to sample into */
-        ys = calloc(n > 0 ? n : 1, sizeof(double));
-        if (ys == NULL) {
-            retval = PLFIT_ENOMEM;
-        } else {
-            /* The main for loop starts here. */
-#ifdef _OPENMP
-#pragma omp for reduction(+:successes)
-#endif
-            for (i = 0; i < num_trials; i++) {
-                plfit_i_resample_discrete(xs_head, num_smaller, n, result->alpha,
-                        result->xmin, n, p_rng, ys);
-                if (xmin_fixed) {
-                    plfit_estimate_alpha_discrete(ys, n, result->xmin,
-                                &options_no_p_value, &result_synthetic);
-                } else {
-                    plfit_discrete(ys, n, &options_no_p_value, &result_synthetic);
-                }
-                if (result_synthetic.D > result->D)
-                    successes++;
-            }
-
-            free(ys);
-        }
-
-        /* End of parallelized part */
-    }
-
-    free(xs_head);
-
-    if (retval == PLFIT_SUCCESS) {
-        result->p = successes / ((double)num_trials);
-    } else {
-        PLFIT_ERROR("cannot calculate exact p-value", retval);
-    }
-
-    return retval;
+    trial.xs_head = dataset->xs;
+    trial.num_smaller = num_smaller;
+    trial.n = n;
+    trial.xmin_fixed = xmin_fixed;
+    trial.result = result;
+    trial.options = *options;
+    trial.options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+    return plfit_i_calculate_p_value_exact('D', n, options->p_value_precision,
+            options->p_value_threshold, options->p_value_checkpoint, options->rng,
+            xmin_fixed, plfit_i_p_value_trial_discrete, &trial, result);
 }
 
 int plfit_log_likelihood_discrete(const double* xs, size_t n, double alpha, double xmin, double* L) {
@@ -1130,9 +2293,28 @@ int plfit_log_likelihood_discrete(const double* xs, size_t n, double alpha, doub
     return PLFIT_SUCCESS;
 }
 
-int plfit_estimate_alpha_discrete(const double* xs, size_t n, double xmin,
+int plfit_log_likelihood_discrete_dataset(plfit_dataset_t* dataset, double alpha,
+        double xmin, double* L) {
+    size_t offset, m;
+
+    if (alpha <= 1) {
+        PLFIT_ERROR("alpha must be greater than one", PLFIT_EINVAL);
+    }
+    XMIN_CHECK_ONE;
+
+    PLFIT_CHECK(plfit_i_dataset_prepare_logs(dataset));
+
+    offset = plfit_i_dataset_tail(dataset, xmin);
+    m = dataset->n - offset;
+    *L = - alpha * dataset->logsums[offset] - m * hsl_sf_lnhzeta(alpha, xmin);
+
+    return PLFIT_SUCCESS;
+}
+
+int plfit_estimate_alpha_discrete_dataset(plfit_dataset_t* dataset, double xmin,
         const plfit_discrete_options_t* options, plfit_result_t *result) {
-    double *xs_copy, *begin, *end;
+    double *begin, *end;
+    size_t offset, n = dataset->n;
 
     if (!options)
         options = &plfit_discrete_default_options;
@@ -1151,36 +2333,203 @@ int plfit_estimate_alpha_discrete(const double* xs, size_t n, double xmin,
         }
     }
 
-    PLFIT_CHECK(plfit_i_copy_and_sort(xs, n, &xs_copy));
+    PLFIT_CHECK(plfit_i_dataset_prepare_logs(dataset));
 
-    begin = xs_copy; end = xs_copy + n;
-    while (begin < end && *begin < xmin)
-        begin++;
+    offset = plfit_i_dataset_tail(dataset, xmin);
+    begin = dataset->xs + offset;
+    end = dataset->xs + n;
 
-    PLFIT_CHECK(plfit_i_estimate_alpha_discrete(begin, end-begin, xmin, &result->alpha,
-                options, /* sorted = */ 1));
-    PLFIT_CHECK(plfit_i_ks_test_discrete(begin, end, result->alpha, xmin, &result->D));
+    PLFIT_CHECK(plfit_i_estimate_alpha_discrete_from_logsum(end-begin,
+                dataset->logsums[offset], xmin, NAN, NAN, &result->alpha, options));
+    PLFIT_CHECK(plfit_i_ks_test_discrete(begin, end, result->alpha, xmin, DBL_MAX,
+                &result->D));
 
     result->xmin = xmin;
     if (options->finite_size_correction)
         plfit_i_perform_finite_size_correction(result, end-begin);
 
-    PLFIT_CHECK(plfit_log_likelihood_discrete(begin, end-begin, result->alpha,
+    PLFIT_CHECK(plfit_log_likelihood_discrete_dataset(dataset, result->alpha,
                 result->xmin, &result->L));
-    PLFIT_CHECK(plfit_i_calculate_p_value_discrete(xs, n, options, 1, result));
+    PLFIT_CHECK(plfit_i_calculate_p_value_discrete(dataset, options, 1, result));
+
+    return PLFIT_SUCCESS;
+}
+
+int plfit_estimate_alpha_discrete(const double* xs, size_t n, double xmin,
+        const plfit_discrete_options_t* options, plfit_result_t *result) {
+    plfit_dataset_t dataset;
+    int retval;
+
+    DATA_POINTS_CHECK;
+
+    /* Only the tail above xmin has to be sorted; the head is needed for
+     * the p-value calculation but its order does not matter */
+    PLFIT_CHECK(plfit_i_dataset_init_tail(&dataset, xs, n, xmin, /* sorted = */ 0));
+    retval = plfit_estimate_alpha_discrete_dataset(&dataset, xmin, options, result);
+    plfit_dataset_destroy(&dataset);
+
+    return retval;
+}
+
+typedef struct {
+    const double *begin;  /**< Pointer to the beginning of the sorted data */
+    const double *end;    /**< Pointer to after the end of the sorted data */
+    const double *logsums; /**< Suffix sums of the logarithms, aligned with begin */
+    const plfit_sorted_runs_t* runs; /**< Runs of identical elements in the array */
+    size_t first_probe;   /**< Index of the run that is probed first */
+    size_t num_probes;    /**< Number of probes */
+    const plfit_discrete_options_t* options; /**< Options of the fit */
+} plfit_discrete_xmin_opt_data_t;
+
+/* Number of consecutive probes that a thread of the discrete xmin scan takes
+ * at once. The alpha estimate is warm-started within such a chunk only, so
+ * the result does not depend on how the chunks are distributed. */
+#define PLFIT_DISCRETE_XMIN_CHUNK_SIZE 10
+
+static int plfit_i_discrete_xmin_opt_linear_scan(
+        const plfit_discrete_xmin_opt_data_t* opt_data, plfit_result_t* best_result,
+        size_t* best_n) {
+    /* this must be signed because OpenMP with Windows MSVC needs signed for
+     * loop index variables. ssize_t will not work because that is a POSIX
+     * extension */
+    ptrdiff_t i = 0;
+    ptrdiff_t num_probes = opt_data->num_probes, global_best_index;
+    plfit_result_t global_best_result;
+    size_t global_best_n;
+    double global_bound;
+    int retval = PLFIT_SUCCESS;
+
+    /* Prepare some variables */
+    global_best_n = 0;
+    global_best_index = num_probes;
+    global_bound = DBL_MAX;
+    global_best_result.D = DBL_MAX;
+    global_best_result.xmin = 1;
+    global_best_result.alpha = 1;
+
+    /* This follows the structure of the continuous linear scan: each thread
+     * finds the best candidate of the probes assigned to it, the threads share
+     * the best D-score found so far to cut the KS tests short, and the local
+     * results are merged in a critical section at the end.
+     *
+     * Each thread receives its probes in increasing order, so keeping the
+     * first local candidate with the lowest D-score, and breaking ties by the
+     * index of the probe when merging, yields the same result as the serial
+     * scan regardless of the number of threads. A candidate whose KS test was
+     * cut short has a D-score larger than the candidate that set the bound,
+     * so it never wins the comparison.
+     *
+     * The MLE of alpha changes little between adjacent candidates, so the
+     * iterative estimators start from the estimate of the previous probe in
+     * the same chunk instead of from scratch.
+     */
+#ifdef _OPENMP
+#pragma omp parallel shared(global_best_result, global_best_n, global_best_index, global_bound, retval) private(i)
+#endif
+    {
+        plfit_result_t local_best_result;
+        ptrdiff_t local_best_index = num_probes;
+        size_t local_best_n = 0, offset;
+        double curr_alpha = NAN, prev_alpha = NAN, alpha_step, curr_D, cutoff;
+        const double *px;
+        int local_retval = PLFIT_SUCCESS;
+
+        local_best_result.D = DBL_MAX;
+        local_best_result.xmin = 1;
+        local_best_result.alpha = 1;
+        local_best_result.p = NAN;
+        local_best_result.num_trials = 0;
+        local_best_result.L = NAN;
+
+#ifdef _OPENMP
+#pragma omp for nowait schedule(dynamic,PLFIT_DISCRETE_XMIN_CHUNK_SIZE)
+#endif
+        for (i = 0; i < num_probes; i++) {
+            if (local_retval)
+                continue;
+
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+            cutoff = global_bound;
+
+            offset = plfit_sorted_runs_start(opt_data->runs, opt_data->first_probe + i);
+            px = opt_data->begin + offset;
+
+            /* Warm-start from the previous probe of the chunk, expecting
+             * the optimum within a few times the last change of alpha */
+            if (i % PLFIT_DISCRETE_XMIN_CHUNK_SIZE == 0) {
+                curr_alpha = prev_alpha = NAN;
+            }
+            alpha_step = 4 * fabs(curr_alpha - prev_alpha);
+            prev_alpha = curr_alpha;
+
+            local_retval = plfit_i_estimate_alpha_discrete_from_logsum(opt_data->end - px,
+                    opt_data->logsums[offset], *px, prev_alpha, alpha_step, &curr_alpha,
+                    opt_data->options);
+            if (local_retval)
+                continue;
+
+            local_retval = plfit_i_ks_test_discrete(px, opt_data->end, curr_alpha, *px,
+                    cutoff, &curr_D);
+            if (local_retval)
+                continue;
+
+            if (curr_D < local_best_result.D) {
+                local_best_result.alpha = curr_alpha;
+                local_best_result.xmin = *px;
+                local_best_result.D = curr_D;
+                local_best_n = opt_data->end - px;
+                local_best_index = i;
+
+                /* Tighten the shared bound for the other threads */
+#ifdef _OPENMP
+#pragma omp critical (plfit_i_discrete_xmin_bound)
+#endif
+                {
+                    if (curr_D < global_bound) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                        global_bound = curr_D;
+                    }
+                }
+            }
+        }
+
+        /* Critical section that finds the global best result from the
+         * local ones collected by each thread */
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+        {
+            if (local_retval && !retval)
+                retval = local_retval;
+
+            if (local_best_result.D < global_best_result.D ||
+                    (local_best_result.D == global_best_result.D &&
+                     local_best_index < global_best_index)) {
+                global_best_result = local_best_result;
+                global_best_n = local_best_n;
+                global_best_index = local_best_index;
+            }
+        }
+    }
 
-    free(xs_copy);
+    if (retval)
+        return retval;
+
+    *best_result = global_best_result;
+    *best_n = global_best_n;
 
     return PLFIT_SUCCESS;
 }
 
-int plfit_discrete(const double* xs, size_t n, const plfit_discrete_options_t* options,
+int plfit_discrete_dataset(plfit_dataset_t* dataset, const plfit_discrete_options_t* options,
         plfit_result_t* result) {
-    double curr_D, curr_alpha;
+    plfit_discrete_xmin_opt_data_t opt_data;
     plfit_result_t best_result;
-    double *xs_copy, *px, *end, *end_xmin, prev_x;
-    size_t best_n;
-    size_t m;
+    size_t best_n, num_runs, n = dataset->n;
 
     if (!options)
         options = &plfit_discrete_default_options;
@@ -1199,81 +2548,98 @@ int plfit_discrete(const double* xs, size_t n, const plfit_discrete_options_t* o
         }
     }
 
-    PLFIT_CHECK(plfit_i_copy_and_sort(xs, n, &xs_copy));
-
-    best_result.D = DBL_MAX;
-    best_result.xmin = 1;
-    best_result.alpha = 1;
-    best_n = 0;
-
-    /* Skip initial values from xs_copy until we get to a positive element or
-     * until we reach the end of the array */
-    px = xs_copy; end = px + n; end_xmin = end - 1;
-    while (px < end && *px < 1) {
-        px++;
+    /* The first element of each block of identical elements in the sorted
+     * dataset is a candidate for xmin. The suffix sums of the logarithms give
+     * the log-sum of the tail of any candidate in constant time */
+    PLFIT_CHECK(plfit_i_dataset_get_runs(dataset, &opt_data.runs));
+    PLFIT_CHECK(plfit_i_dataset_prepare_logs(dataset));
+
+    opt_data.begin = dataset->xs;
+    opt_data.end = dataset->xs + n;
+    opt_data.logsums = dataset->logsums;
+    opt_data.options = options;
+
+    /* Skip the blocks of elements smaller than one */
+    num_runs = opt_data.runs->num_runs;
+    opt_data.first_probe = 0;
+    while (opt_data.first_probe < num_runs &&
+            dataset->xs[plfit_sorted_runs_start(opt_data.runs, opt_data.first_probe)] < 1) {
+        opt_data.first_probe++;
     }
 
-    /* Make sure there are at least three distinct values if possible */
-    m = px - xs_copy;
-    prev_x = *end_xmin;
-    while (end_xmin > px && *end_xmin == prev_x) {
-        end_xmin--;
-    }
-    prev_x = *end_xmin;
-    while (end_xmin > px && *end_xmin == prev_x) {
-        end_xmin--;
+    /* The last two distinct values are not tried as xmin, but we always try
+     * at least one value if there is any */
+    opt_data.num_probes = num_runs - opt_data.first_probe;
+    if (opt_data.num_probes > 3) {
+        opt_data.num_probes -= 2;
+    } else if (opt_data.num_probes > 0) {
+        opt_data.num_probes = 1;
     }
 
-    prev_x = 0;
-    end_xmin++;
-    while (px < end_xmin) {
-        while (px < end_xmin && *px == prev_x) {
-            px++; m++;
-        }
-
-        PLFIT_CHECK(
-            plfit_i_estimate_alpha_discrete(
-                px, n-m, *px, &curr_alpha, options, /* sorted = */ 1
-            )
-        );
-        PLFIT_CHECK(
-            plfit_i_ks_test_discrete(px, end, curr_alpha, *px, &curr_D)
-        );
-
-        if (curr_D < best_result.D) {
-            best_result.alpha = curr_alpha;
-            best_result.xmin = *px;
-            best_result.D = curr_D;
-            best_n = n-m;
-        }
-
-        prev_x = *px;
-        px++; m++;
-    }
+    PLFIT_CHECK(plfit_i_discrete_xmin_opt_linear_scan(&opt_data, &best_result, &best_n));
 
     *result = best_result;
     if (options->finite_size_correction)
         plfit_i_perform_finite_size_correction(result, best_n);
 
-    PLFIT_CHECK(plfit_log_likelihood_discrete(xs_copy + n - best_n, best_n,
-                result->alpha, result->xmin, &result->L));
-    PLFIT_CHECK(plfit_i_calculate_p_value_discrete(xs_copy, n, options, 0, result));
-
-    free(xs_copy);
+    PLFIT_CHECK(plfit_log_likelihood_discrete_dataset(dataset, result->alpha,
+                result->xmin, &result->L));
+    PLFIT_CHECK(plfit_i_calculate_p_value_discrete(dataset, options, 0, result));
 
     return PLFIT_SUCCESS;
 }
 
+int plfit_discrete(const double* xs, size_t n, const plfit_discrete_options_t* options,
+        plfit_result_t* result) {
+    plfit_dataset_t dataset;
+    int retval;
+
+    DATA_POINTS_CHECK;
+
+    /* The xmin scan needs the blocks of identical elements, which are found
+     * while sorting the data */
+    PLFIT_CHECK(plfit_i_dataset_init(&dataset, xs, n, /* with_runs = */ 1));
+    retval = plfit_discrete_dataset(&dataset, options, result);
+    plfit_dataset_destroy(&dataset);
+
+    return retval;
+}
+
+/**
+ * Fits a discrete power-law distribution to a sample that is already sorted
+ * in increasing order; see \ref plfit_i_continuous_sorted().
+ */
+static int plfit_i_discrete_sorted(const double* xs, size_t n, plfit_bool_t xmin_fixed,
+        double xmin, const plfit_discrete_options_t* options, plfit_result_t* result) {
+    plfit_dataset_t dataset;
+    int retval;
+
+    if (xmin_fixed) {
+        PLFIT_CHECK(plfit_i_dataset_init_tail(&dataset, xs, n, xmin, /* sorted = */ 1));
+        retval = plfit_estimate_alpha_discrete_dataset(&dataset, xmin, options, result);
+    } else {
+        PLFIT_CHECK(plfit_i_dataset_init_sorted(&dataset, xs, n));
+        retval = plfit_discrete_dataset(&dataset, options, result);
+    }
+    plfit_dataset_destroy(&dataset);
+
+    return retval;
+}
+
+
 /***** resampling routines to generate synthetic replicates ****/
 
 static int plfit_i_resample_continuous(const double* xs_head, size_t num_smaller,
         size_t n, double alpha, double xmin, size_t num_samples, plfit_mt_rng_t* rng,
         double* result)
 {
+    plfit_rbinom_state_t binom_state;
     size_t num_orig_samples, i;
 
     /* Calculate how many samples have to be drawn from xs_head */
-    num_orig_samples = (size_t) plfit_rbinom(num_samples, num_smaller / (double)n, rng);
+    plfit_rbinom_state_init(&binom_state);
+    num_orig_samples = (size_t) plfit_rbinom_state_sample(&binom_state, num_samples,
+            num_smaller / (double)n, rng);
 
     /* Draw the samples from xs_head */
     for (i = 0; i < num_orig_samples; i++, result++) {
@@ -1311,10 +2677,13 @@ static int plfit_i_resample_discrete(const double* xs_head, size_t num_smaller,
         double alpha, double xmin, size_t num_samples, plfit_mt_rng_t* rng,
         double* result)
 {
+    plfit_rbinom_state_t binom_state;
     size_t num_orig_samples, i;
 
     /* Calculate how many samples have to be drawn from xs_head */
-    num_orig_samples = (size_t) plfit_rbinom(num_samples, num_smaller / (double)n, rng);
+    plfit_rbinom_state_init(&binom_state);
+    num_orig_samples = (size_t) plfit_rbinom_state_sample(&binom_state, num_samples,
+            num_smaller / (double)n, rng);
 
     /* Draw the samples from xs_head */
     for (i = 0; i < num_orig_samples; i++, result++) {
@@ -1348,30 +2717,150 @@ int plfit_resample_discrete(const double* xs, size_t n, double alpha, double xmi
     return retval;
 }
 
+/**
+ * Draws a sorted sample of the given size from the uniform distribution on
+ * the open interval (0; 1), i.e. the order statistics of that many uniform
+ * random numbers. The cumulative sums of n+1 exponential spacings, divided
+ * by their total, are distributed like the order statistics, so no sorting
+ * is needed.
+ */
+static void plfit_i_sorted_uniforms(size_t n, plfit_mt_rng_t* rng, double* result) {
+    double sum = 0.0;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        sum -= log((plfit_mt_random(rng) + 0.5) / 4294967296.0);
+        result[i] = sum;
+    }
+    sum -= log((plfit_mt_random(rng) + 0.5) / 4294967296.0);
+
+    sum = 1.0 / sum;
+    for (i = 0; i < n; i++) {
+        result[i] *= sum;
+    }
+}
+
+/**
+ * Draws the given number of samples with replacement from \c xs_head, picking
+ * the elements at sorted uniform positions. This is equivalent to drawing
+ * multinomial counts for the elements and writing them out in order, so the
+ * samples are in increasing order if \c xs_head is sorted.
+ */
+static void plfit_i_resample_head_sorted(const double* xs_head, size_t num_smaller,
+        size_t num_samples, plfit_mt_rng_t* rng, double* result) {
+    size_t i, j;
+
+    plfit_i_sorted_uniforms(num_samples, rng, result);
+    for (i = 0; i < num_samples; i++) {
+        j = (size_t)(result[i] * num_smaller);
+        result[i] = xs_head[j < num_smaller ? j : num_smaller - 1];
+    }
+}
+
+/**
+ * Variant of \ref plfit_i_resample_continuous() that returns the samples in
+ * increasing order if \c xs_head is sorted. Otherwise only the samples
+ * taken from the fitted distribution are sorted, which is still enough for
+ * fits with a fixed xmin. The samples taken from the
+ * fitted distribution are obtained by pushing sorted uniform numbers through
+ * the inverse CDF of the Pareto distribution, which is increasing.
+ */
+static int plfit_i_resample_continuous_sorted(const double* xs_head, size_t num_smaller,
+        size_t n, double alpha, double xmin, size_t num_samples,
+        plfit_rbinom_state_t* binom_state, plfit_mt_rng_t* rng, double* result)
+{
+    size_t num_orig_samples, i;
+    double gamma;
+
+    if (alpha <= 1) {
+        PLFIT_ERROR("alpha must be greater than one", PLFIT_EINVAL);
+    }
+    XMIN_CHECK_ZERO;
+
+    /* Calculate how many samples have to be drawn from xs_head */
+    num_orig_samples = (size_t) plfit_rbinom_state_sample(binom_state, num_samples,
+            num_smaller / (double)n, rng);
+
+    /* Draw the samples from xs_head; all of them are smaller than xmin */
+    plfit_i_resample_head_sorted(xs_head, num_smaller, num_orig_samples, rng, result);
+    result += num_orig_samples;
+    num_samples -= num_orig_samples;
+
+    /* Draw the remaining samples from the fitted distribution */
+    gamma = -1.0 / (alpha - 1);
+    plfit_i_sorted_uniforms(num_samples, rng, result);
+    for (i = 0; i < num_samples; i++) {
+        result[i] = pow(1 - result[i], gamma) * xmin;
+    }
+
+    return PLFIT_SUCCESS;
+}
+
+/**
+ * Variant of \ref plfit_i_resample_discrete() that returns the samples in
+ * increasing order if \c xs_head is sorted; see
+ * \ref plfit_i_resample_continuous_sorted(). The zeta distribution has no
+ * inverse CDF that is cheap to evaluate, so the samples taken from the fitted
+ * distribution are drawn as usual and only they are sorted.
+ */
+static int plfit_i_resample_discrete_sorted(const double* xs_head, size_t num_smaller,
+        size_t n, double alpha, double xmin, size_t num_samples,
+        plfit_rbinom_state_t* binom_state, plfit_mt_rng_t* rng, double* result)
+{
+    size_t num_orig_samples;
+
+    /* Calculate how many samples have to be drawn from xs_head */
+    num_orig_samples = (size_t) plfit_rbinom_state_sample(binom_state, num_samples,
+            num_smaller / (double)n, rng);
+
+    /* Draw the samples from xs_head; all of them are smaller than xmin */
+    plfit_i_resample_head_sorted(xs_head, num_smaller, num_orig_samples, rng, result);
+    result += num_orig_samples;
+    num_samples -= num_orig_samples;
+
+    /* Draw the remaining samples from the fitted distribution */
+    PLFIT_CHECK(plfit_rzeta_array((long int)xmin, alpha, num_samples, rng, result));
+    plfit_introsort_doubles(result, num_samples);
+
+    return PLFIT_SUCCESS;
+}
+
 /******** calculating the p-value of a fitted model only *******/
 
+int plfit_calculate_p_value_continuous_dataset(plfit_dataset_t* dataset,
+        const plfit_continuous_options_t* options, plfit_bool_t xmin_fixed,
+        plfit_result_t *result) {
+    return plfit_i_calculate_p_value_continuous(dataset, options, xmin_fixed, result);
+}
+
 int plfit_calculate_p_value_continuous(const double* xs, size_t n,
         const plfit_continuous_options_t* options, plfit_bool_t xmin_fixed,
         plfit_result_t *result) {
-    double* xs_copy;
+    plfit_dataset_t dataset;
+    int retval;
 
-    PLFIT_CHECK(plfit_i_copy_and_sort(xs, n, &xs_copy));
-    PLFIT_CHECK(plfit_i_calculate_p_value_continuous(xs_copy, n, options,
-                xmin_fixed, result));
-    free(xs_copy);
+    PLFIT_CHECK(plfit_dataset_init(&dataset, xs, n));
+    retval = plfit_i_calculate_p_value_continuous(&dataset, options, xmin_fixed, result);
+    plfit_dataset_destroy(&dataset);
 
-    return PLFIT_SUCCESS;
+    return retval;
+}
+
+int plfit_calculate_p_value_discrete_dataset(plfit_dataset_t* dataset,
+        const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
+        plfit_result_t *result) {
+    return plfit_i_calculate_p_value_discrete(dataset, options, xmin_fixed, result);
 }
 
 int plfit_calculate_p_value_discrete(const double* xs, size_t n,
         const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
         plfit_result_t *result) {
-    double* xs_copy;
+    plfit_dataset_t dataset;
+    int retval;
 
-    PLFIT_CHECK(plfit_i_copy_and_sort(xs, n, &xs_copy));
-    PLFIT_CHECK(plfit_i_calculate_p_value_discrete(xs_copy, n, options,
-                xmin_fixed, result));
-    free(xs_copy);
+    PLFIT_CHECK(plfit_dataset_init(&dataset, xs, n));
+    retval = plfit_i_calculate_p_value_discrete(&dataset, options, xmin_fixed, result);
+    plfit_dataset_destroy(&dataset);
 
-    return PLFIT_SUCCESS;
+    return retval;
 }
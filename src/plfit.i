@@ -61,6 +61,7 @@ typedef enum {
     PLFIT_LINEAR_ONLY,
     PLFIT_STRATIFIED_SAMPLING,
     PLFIT_GSS_OR_LINEAR,
+    PLFIT_HIERARCHICAL_SAMPLING,
     PLFIT_DEFAULT_CONTINUOUS_METHOD = PLFIT_STRATIFIED_SAMPLING
 } plfit_continuous_method_t;
 
@@ -68,6 +69,7 @@ typedef enum {
     PLFIT_LBFGS,
     PLFIT_LINEAR_SCAN,
     PLFIT_PRETEND_CONTINUOUS,
+    PLFIT_NEWTON,
     PLFIT_DEFAULT_DISCRETE_METHOD = PLFIT_LBFGS
 } plfit_discrete_method_t;
 
@@ -84,6 +86,7 @@ typedef struct _plfit_result_t {
     double L;
     double D;
     double p;
+    long int num_trials;
 
     %extend {
         char *__str__() {
@@ -101,6 +104,12 @@ typedef struct _plfit_continuous_options_t {
     plfit_p_value_method_t p_value_method;
     double p_value_precision;
     plfit_mt_rng_t* rng;
+    struct {
+        size_t keep;
+        double tolerance;
+    } hierarchical;
+    double p_value_threshold;
+    const char* p_value_checkpoint;
 
     %extend {
         _plfit_continuous_options_t() {
@@ -113,9 +122,11 @@ typedef struct _plfit_continuous_options_t {
         char *__str__() {
             static char temp[512];
             sprintf(temp, "finite_size_correction = %d, xmin_method = %d, "
-                "p_value_method = %d, p_value_precision = %lg",
+                "p_value_method = %d, p_value_precision = %lg, p_value_threshold = %lg, "
+                "hierarchical.keep = %lu, hierarchical.tolerance = %lg",
                 $self->finite_size_correction, $self->xmin_method,
-                $self->p_value_method, $self->p_value_precision);
+                $self->p_value_method, $self->p_value_precision, $self->p_value_threshold,
+                (unsigned long)$self->hierarchical.keep, $self->hierarchical.tolerance);
             return temp;
         }
     }
@@ -132,6 +143,8 @@ typedef struct _plfit_discrete_options_t {
     plfit_p_value_method_t p_value_method;
     double p_value_precision;
     plfit_mt_rng_t* rng;
+    double p_value_threshold;
+    const char* p_value_checkpoint;
 
     %extend {
         _plfit_discrete_options_t() {
@@ -145,10 +158,10 @@ typedef struct _plfit_discrete_options_t {
             static char temp[512];
             sprintf(temp, "finite_size_correction = %d, alpha_method = %d, "
                 "alpha.min = %lg, alpha.step = %lg, alpha.max = %lg, "
-                "p_value_method = %d, p_value_precision = %lg",
+                "p_value_method = %d, p_value_precision = %lg, p_value_threshold = %lg",
                 $self->finite_size_correction, $self->alpha_method,
                 $self->alpha.min, $self->alpha.step, $self->alpha.max,
-                $self->p_value_method, $self->p_value_precision);
+                $self->p_value_method, $self->p_value_precision, $self->p_value_threshold);
             return temp;
         }
     }
@@ -198,6 +211,29 @@ typedef struct _plfit_discrete_options_t {
     $result = l_output_helper($result, o);
 }
 
+/* Prepared datasets */
+typedef struct _plfit_dataset_t {
+    %immutable;
+    size_t n;
+    %mutable;
+
+    %extend {
+        _plfit_dataset_t(double* xs, size_t n) {
+            plfit_dataset_t* obj = (plfit_dataset_t*)malloc(sizeof(plfit_dataset_t));
+            if (obj != NULL && plfit_dataset_init(obj, xs, n)) {
+                free(obj);
+                obj = NULL;
+            }
+            return obj;
+        }
+
+        ~_plfit_dataset_t() {
+            plfit_dataset_destroy($self);
+            free($self);
+        }
+    }
+} plfit_dataset_t;
+
 /* Module initialization */
 %init {
     plfit_set_error_handler(plfit_error_handler_ignore);
@@ -222,6 +258,13 @@ int plfit_estimate_alpha_continuous(double* xs, size_t n, double xmin,
 int plfit_continuous(double* xs, size_t n,
         const plfit_continuous_options_t* options=0, plfit_result_t* OUTPUT);
 
+int plfit_log_likelihood_continuous_dataset(plfit_dataset_t* dataset, double alpha,
+        double xmin, double* OUTPUT);
+int plfit_estimate_alpha_continuous_dataset(plfit_dataset_t* dataset, double xmin,
+        const plfit_continuous_options_t* options=0, plfit_result_t* OUTPUT);
+int plfit_continuous_dataset(plfit_dataset_t* dataset,
+        const plfit_continuous_options_t* options=0, plfit_result_t* OUTPUT);
+
 /********** discrete power law distribution fitting **********/
 
 int plfit_estimate_alpha_discrete(double* xs, size_t n, double xmin,
@@ -232,6 +275,14 @@ int plfit_discrete(double* xs, size_t n,
         const plfit_discrete_options_t* options=0,
         plfit_result_t* OUTPUT);
 
+int plfit_estimate_alpha_discrete_dataset(plfit_dataset_t* dataset, double xmin,
+        const plfit_discrete_options_t* options=0, plfit_result_t* OUTPUT);
+int plfit_log_likelihood_discrete_dataset(plfit_dataset_t* dataset, double alpha,
+        double xmin, double* OUTPUT);
+int plfit_discrete_dataset(plfit_dataset_t* dataset,
+        const plfit_discrete_options_t* options=0,
+        plfit_result_t* OUTPUT);
+
 /***** resampling routines to generate synthetic replicates ****/
 
 int plfit_resample_continuous(double* xs, size_t n, double alpha, double xmin,
@@ -247,6 +298,12 @@ int plfit_calculate_p_value_continuous(double* xs, size_t n,
 int plfit_calculate_p_value_discrete(double* xs, size_t n,
         const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
         plfit_result_t *OUTPUT);
+int plfit_calculate_p_value_continuous_dataset(plfit_dataset_t* dataset,
+        const plfit_continuous_options_t* options, plfit_bool_t xmin_fixed,
+        plfit_result_t *OUTPUT);
+int plfit_calculate_p_value_discrete_dataset(plfit_dataset_t* dataset,
+        const plfit_discrete_options_t* options, plfit_bool_t xmin_fixed,
+        plfit_result_t *OUTPUT);
 
 /************* calculating descriptive statistics **************/
 
@@ -47,17 +47,16 @@
 
 #define repeat for(;;)
 
-double plfit_rbinom(double nin, double pp, plfit_mt_rng_t* rng)
+void plfit_rbinom_state_init(plfit_rbinom_state_t* state)
 {
-    /* FIXME: These should become THREAD_specific globals : */
-
-    static double c, fm, npq, p1, p2, p3, p4, qn;
-    static double xl, xll, xlr, xm, xr;
-
-    static double psave = -1.0;
-    static int nsave = -1;
-    static int m;
+    state->psave = -1.0;
+    state->nsave = -1;
+    state->m = 0;
+}
 
+double plfit_rbinom_state_sample(plfit_rbinom_state_t* state, double nin, double pp,
+        plfit_mt_rng_t* rng)
+{
     double f, f1, f2, u, v, w, w2, x, x1, x2, z, z2;
     double p, q, np, g, r, al, alv, amaxp, ffm, ynorm;
     int i, ix, k, n;
@@ -80,88 +79,85 @@ double plfit_rbinom(double nin, double pp, plfit_mt_rng_t* rng)
     r = p / q;
     g = r * (n + 1);
 
-    /* Setup, perform only when parameters change [using static (globals): */
-
-    /* FIXING: Want this thread safe
-       -- use as little (thread globals) as possible
-    */
-    if (pp != psave || n != nsave) {
-	psave = pp;
-	nsave = n;
+    /* Setup, perform only when parameters change; the setup is cached in
+     * the state object so each thread can have its own */
+    if (pp != state->psave || n != state->nsave) {
+	state->psave = pp;
+	state->nsave = n;
 	if (np < 30.0) {
 	    /* inverse cdf logic for mean less than 30 */
-	    qn = pow(q, (double) n);
+	    state->qn = pow(q, (double) n);
 	    goto L_np_small;
 	} else {
 	    ffm = np + p;
-	    m = (int) ffm;
-	    fm = m;
-	    npq = np * q;
-	    p1 = (int)(2.195 * sqrt(npq) - 4.6 * q) + 0.5;
-	    xm = fm + 0.5;
-	    xl = xm - p1;
-	    xr = xm + p1;
-	    c = 0.134 + 20.5 / (15.3 + fm);
-	    al = (ffm - xl) / (ffm - xl * p);
-	    xll = al * (1.0 + 0.5 * al);
-	    al = (xr - ffm) / (xr * q);
-	    xlr = al * (1.0 + 0.5 * al);
-	    p2 = p1 * (1.0 + c + c);
-	    p3 = p2 + c / xll;
-	    p4 = p3 + c / xlr;
+	    state->m = (int) ffm;
+	    state->fm = state->m;
+	    state->npq = np * q;
+	    state->p1 = (int)(2.195 * sqrt(state->npq) - 4.6 * q) + 0.5;
+	    state->xm = state->fm + 0.5;
+	    state->xl = state->xm - state->p1;
+	    state->xr = state->xm + state->p1;
+	    state->c = 0.134 + 20.5 / (15.3 + state->fm);
+	    al = (ffm - state->xl) / (ffm - state->xl * p);
+	    state->xll = al * (1.0 + 0.5 * al);
+	    al = (state->xr - ffm) / (state->xr * q);
+	    state->xlr = al * (1.0 + 0.5 * al);
+	    state->p2 = state->p1 * (1.0 + state->c + state->c);
+	    state->p3 = state->p2 + state->c / state->xll;
+	    state->p4 = state->p3 + state->c / state->xlr;
 	}
-    } else if (n == nsave) {
+    } else if (n == state->nsave) {
 	if (np < 30.0)
 	    goto L_np_small;
     }
 
     /*-------------------------- np = n*p >= 30 : ------------------- */
     repeat {
-      u = plfit_runif_01(rng) * p4;
+      u = plfit_runif_01(rng) * state->p4;
       v = plfit_runif_01(rng);
       /* triangular region */
-      if (u <= p1) {
-	  ix = (int)(xm - p1 * v + u);
+      if (u <= state->p1) {
+	  ix = (int)(state->xm - state->p1 * v + u);
 	  goto finis;
       }
       /* parallelogram region */
-      if (u <= p2) {
-	  x = xl + (u - p1) / c;
-	  v = v * c + 1.0 - fabs(xm - x) / p1;
+      if (u <= state->p2) {
+	  x = state->xl + (u - state->p1) / state->c;
+	  v = v * state->c + 1.0 - fabs(state->xm - x) / state->p1;
 	  if (v > 1.0 || v <= 0.)
 	      continue;
 	  ix = (int) x;
       } else {
-	  if (u > p3) {	/* right tail */
-	      ix = (int)(xr - log(v) / xlr);
+	  if (u > state->p3) {	/* right tail */
+	      ix = (int)(state->xr - log(v) / state->xlr);
 	      if (ix > n)
 		  continue;
-	      v = v * (u - p3) * xlr;
+	      v = v * (u - state->p3) * state->xlr;
 	  } else {/* left tail */
-	      ix = (int)(xl + log(v) / xll);
+	      ix = (int)(state->xl + log(v) / state->xll);
 	      if (ix < 0)
 		  continue;
-	      v = v * (u - p2) * xll;
+	      v = v * (u - state->p2) * state->xll;
 	  }
       }
       /* determine appropriate way to perform accept/reject test */
-      k = abs(ix - m);
-      if (k <= 20 || k >= npq / 2 - 1) {
+      k = abs(ix - state->m);
+      if (k <= 20 || k >= state->npq / 2 - 1) {
 	  /* explicit evaluation */
 	  f = 1.0;
-	  if (m < ix) {
-	      for (i = m + 1; i <= ix; i++)
+	  if (state->m < ix) {
+	      for (i = state->m + 1; i <= ix; i++)
 		  f *= (g / i - r);
-	  } else if (m != ix) {
-	      for (i = ix + 1; i <= m; i++)
+	  } else if (state->m != ix) {
+	      for (i = ix + 1; i <= state->m; i++)
 		  f /= (g / i - r);
 	  }
 	  if (v <= f)
 	      goto finis;
       } else {
 	  /* squeezing using upper and lower bounds on log(f(x)) */
-	  amaxp = (k / npq) * ((k * (k / 3. + 0.625) + (1.0 / 6.0)) / npq + 0.5);
-	  ynorm = -k * k / (2.0 * npq);
+	  amaxp = (k / state->npq) * ((k * (k / 3. + 0.625) + (1.0 / 6.0)) / state->npq + 0.5);
+	  ynorm = -k * k / (2.0 * state->npq);
 	  alv = log(v);
 	  if (alv < ynorm - amaxp)
 	      goto finis;
@@ -169,14 +165,14 @@ double plfit_rbinom(double nin, double pp, plfit_mt_rng_t* rng)
 	      /* stirling's formula to machine accuracy */
 	      /* for the final acceptance/rejection test */
 	      x1 = ix + 1;
-	      f1 = fm + 1.0;
-	      z = n + 1 - fm;
+	      f1 = state->fm + 1.0;
+	      z = n + 1 - state->fm;
 	      w = n - ix + 1.0;
 	      z2 = z * z;
 	      x2 = x1 * x1;
 	      f2 = f1 * f1;
 	      w2 = w * w;
-	      if (alv <= xm * log(f1 / x1) + (n - m + 0.5) * log(z / w) + (ix - m) * log(w * p / (x1 * q)) + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / f2) / f2) / f2) / f2) / f1 / 166320.0 + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / z2) / z2) / z2) / z2) / z / 166320.0 + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / x2) / x2) / x2) / x2) / x1 / 166320.0 + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / w2) / w2) / w2) / w2) / w / 166320.)
+	      if (alv <= state->xm * log(f1 / x1) + (n - state->m + 0.5) * log(z / w) + (ix - state->m) * log(w * p / (x1 * q)) + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / f2) / f2) / f2) / f2) / f1 / 166320.0 + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / z2) / z2) / z2) / z2) / z / 166320.0 + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / x2) / x2) / x2) / x2) / x1 / 166320.0 + (13860.0 - (462.0 - (132.0 - (99.0 - 140.0 / w2) / w2) / w2) / w2) / w / 166320.)
 		  goto finis;
 	  }
       }
@@ -187,7 +183,7 @@ double plfit_rbinom(double nin, double pp, plfit_mt_rng_t* rng)
 
   repeat {
      ix = 0;
-     f = qn;
+     f = state->qn;
      u = plfit_runif_01(rng);
      repeat {
 	 if (u < f)
@@ -200,7 +196,20 @@ double plfit_rbinom(double nin, double pp, plfit_mt_rng_t* rng)
      }
   }
  finis:
-    if (psave > 0.5)
+    if (state->psave > 0.5)
 	 ix = n - ix;
   return (double)ix;
 }
+
+double plfit_rbinom(double nin, double pp, plfit_mt_rng_t* rng)
+{
+    static plfit_rbinom_state_t state;
+    static int state_initialized = 0;
+
+    if (!state_initialized) {
+        plfit_rbinom_state_init(&state);
+        state_initialized = 1;
+    }
+
+    return plfit_rbinom_state_sample(&state, nin, pp, rng);
+}
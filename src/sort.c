@@ -0,0 +1,532 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+/* sort.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "plfit_error.h"
+#include "sort.h"
+
+/* The radix sort processes the 64-bit keys in six digits of 11 bits each;
+ * the counters of a digit then fit comfortably in the L1 cache */
+#define RADIX_BITS 11
+#define RADIX_SIZE (1 << RADIX_BITS)
+#define RADIX_MASK (RADIX_SIZE - 1)
+#define RADIX_NUM_DIGITS ((64 + RADIX_BITS - 1) / RADIX_BITS)
+
+/* Minimum number of elements per thread in the parallel radix sort */
+#define RADIX_MIN_CHUNK_SIZE 65536
+
+/* Partitions shorter than this are finished with an insertion sort */
+#define INSERTION_SORT_THRESHOLD 16
+
+#define SIGN_BIT UINT64_C(0x8000000000000000)
+
+/* Maps the bit pattern of a double to an unsigned integer key such that the
+ * order of the keys matches the numeric order of the doubles. Positive
+ * numbers get their sign bit flipped, negative ones get all their bits
+ * flipped. */
+static inline uint64_t encode_key(uint64_t bits) {
+    return bits ^ ((uint64_t)(-(int64_t)(bits >> 63)) | SIGN_BIT);
+}
+
+/* Inverse of encode_key() */
+static inline uint64_t decode_key(uint64_t key) {
+    return key ^ (((key >> 63) - 1) | SIGN_BIT);
+}
+
+static inline uint64_t key_of(double x) {
+    uint64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return encode_key(bits);
+}
+
+/* The radix sort keeps keys and doubles in the same buffers, so all accesses
+ * go through memcpy() to stay clear of strict aliasing issues */
+static inline uint64_t load_bits(const void* buf, size_t i) {
+    uint64_t bits;
+    memcpy(&bits, (const char*)buf + i * sizeof(uint64_t), sizeof(bits));
+    return bits;
+}
+
+static inline void store_bits(void* buf, size_t i, uint64_t bits) {
+    memcpy((char*)buf + i * sizeof(uint64_t), &bits, sizeof(bits));
+}
+
+/***** Run-length structure *****/
+
+static int runs_alloc(plfit_sorted_runs_t* runs, size_t n, size_t num_runs) {
+    runs->num_runs = num_runs;
+    runs->starts32 = NULL;
+    runs->starts64 = NULL;
+
+    if (n <= UINT32_MAX) {
+        runs->starts32 = (uint32_t*)malloc(sizeof(uint32_t) * (num_runs + 1));
+        if (runs->starts32 == NULL) {
+            PLFIT_ERROR("cannot allocate run-length structure", PLFIT_ENOMEM);
+        }
+        runs->starts32[num_runs] = n;
+    } else {
+        runs->starts64 = (uint64_t*)malloc(sizeof(uint64_t) * (num_runs + 1));
+        if (runs->starts64 == NULL) {
+            PLFIT_ERROR("cannot allocate run-length structure", PLFIT_ENOMEM);
+        }
+        runs->starts64[num_runs] = n;
+    }
+
+    return PLFIT_SUCCESS;
+}
+
+static inline void runs_set(plfit_sorted_runs_t* runs, size_t i, size_t start) {
+    if (runs->starts32) {
+        runs->starts32[i] = start;
+    } else {
+        runs->starts64[i] = start;
+    }
+}
+
+int plfit_sorted_runs_init(plfit_sorted_runs_t* runs, const double* xs, size_t n) {
+    size_t i, num_runs = n > 0 ? 1 : 0;
+
+    for (i = 1; i < n; i++) {
+        if (xs[i] != xs[i-1])
+            num_runs++;
+    }
+
+    PLFIT_CHECK(runs_alloc(runs, n, num_runs));
+
+    num_runs = 0;
+    for (i = 0; i < n; i++) {
+        if (i == 0 || xs[i] != xs[i-1])
+            runs_set(runs, num_runs++, i);
+    }
+
+    return PLFIT_SUCCESS;
+}
+
+/* Shrinks the run-length structure to the given number of runs, keeping the
+ * first num_runs start offsets, and appends the sentinel */
+static void runs_shrink(plfit_sorted_runs_t* runs, size_t n, size_t num_runs) {
+    void* shrunk;
+
+    runs->num_runs = num_runs;
+    if (runs->starts32) {
+        runs->starts32[num_runs] = n;
+        shrunk = realloc(runs->starts32, sizeof(uint32_t) * (num_runs + 1));
+        if (shrunk != NULL)
+            runs->starts32 = (uint32_t*)shrunk;
+    } else {
+        runs->starts64[num_runs] = n;
+        shrunk = realloc(runs->starts64, sizeof(uint64_t) * (num_runs + 1));
+        if (shrunk != NULL)
+            runs->starts64 = (uint64_t*)shrunk;
+    }
+}
+
+void plfit_sorted_runs_destroy(plfit_sorted_runs_t* runs) {
+    free(runs->starts32);
+    free(runs->starts64);
+    runs->starts32 = NULL;
+    runs->starts64 = NULL;
+    runs->num_runs = 0;
+}
+
+/***** Introsort *****/
+
+static inline void swap_doubles(double* a, double* b) {
+    double tmp = *a;
+    *a = *b;
+    *b = tmp;
+}
+
+static void insertion_sort(double* xs, size_t n) {
+    size_t i, j;
+    double x;
+    uint64_t key;
+
+    for (i = 1; i < n; i++) {
+        x = xs[i];
+        key = key_of(x);
+        for (j = i; j > 0 && key_of(xs[j-1]) > key; j--) {
+            xs[j] = xs[j-1];
+        }
+        xs[j] = x;
+    }
+}
+
+static void sift_down(double* xs, size_t root, size_t n) {
+    size_t child;
+
+    while ((child = 2 * root + 1) < n) {
+        if (child + 1 < n && key_of(xs[child]) < key_of(xs[child+1])) {
+            child++;
+        }
+        if (key_of(xs[root]) >= key_of(xs[child])) {
+            return;
+        }
+        swap_doubles(xs + root, xs + child);
+        root = child;
+    }
+}
+
+static void heap_sort(double* xs, size_t n) {
+    size_t i;
+
+    for (i = n / 2; i > 0; i--) {
+        sift_down(xs, i - 1, n);
+    }
+    for (i = n; i > 1; i--) {
+        swap_doubles(xs, xs + i - 1);
+        sift_down(xs, 0, i - 1);
+    }
+}
+
+static void introsort_loop(double* xs, size_t n, unsigned int depth_limit) {
+    size_t i, j, mid;
+    uint64_t pivot;
+
+    while (n > INSERTION_SORT_THRESHOLD) {
+        if (depth_limit == 0) {
+            heap_sort(xs, n);
+            return;
+        }
+        depth_limit--;
+
+        /* Median of three; afterwards xs[0] <= xs[mid] <= xs[n-1] */
+        mid = n / 2;
+        if (key_of(xs[mid]) < key_of(xs[0]))
+            swap_doubles(xs, xs + mid);
+        if (key_of(xs[n-1]) < key_of(xs[mid])) {
+            swap_doubles(xs + mid, xs + n - 1);
+            if (key_of(xs[mid]) < key_of(xs[0]))
+                swap_doubles(xs, xs + mid);
+        }
+        pivot = key_of(xs[mid]);
+
+        /* Hoare partition; xs[0] and xs[n-1] act as sentinels */
+        i = 0; j = n - 1;
+        while (1) {
+            do { i++; } while (key_of(xs[i]) < pivot);
+            do { j--; } while (key_of(xs[j]) > pivot);
+            if (i >= j)
+                break;
+            swap_doubles(xs + i, xs + j);
+        }
+
+        /* Recurse into the smaller half, loop on the larger one */
+        if (j + 1 < n - j - 1) {
+            introsort_loop(xs, j + 1, depth_limit);
+            xs += j + 1;
+            n -= j + 1;
+        } else {
+            introsort_loop(xs + j + 1, n - j - 1, depth_limit);
+            n = j + 1;
+        }
+    }
+
+    insertion_sort(xs, n);
+}
+
+void plfit_introsort_doubles(double* xs, size_t n) {
+    unsigned int depth_limit = 0;
+    size_t m;
+
+    for (m = n; m > 1; m >>= 1) {
+        depth_limit += 2;
+    }
+
+    introsort_loop(xs, n, depth_limit);
+}
+
+/***** Radix sort *****/
+
+/* Counts the occurrences of the given digit within the given chunk of a
+ * buffer of keys */
+static void radix_count(const void* src, size_t from, size_t to,
+        unsigned int shift, size_t* counts) {
+    size_t i;
+
+    memset(counts, 0, sizeof(size_t) * RADIX_SIZE);
+    for (i = from; i < to; i++) {
+        counts[(load_bits(src, i) >> shift) & RADIX_MASK]++;
+    }
+}
+
+/* Moves the given chunk of the source buffer into the destination buffer,
+ * using the given starting offsets of the buckets. The source contains doubles
+ * instead of keys when encode is nonzero, and the destination receives
+ * doubles instead of keys when decode is nonzero. */
+static void radix_scatter(const void* src, void* dst, size_t from, size_t to,
+        int encode, int decode, unsigned int shift, size_t* offsets) {
+    size_t i;
+    uint64_t key;
+
+    for (i = from; i < to; i++) {
+        key = load_bits(src, i);
+        if (encode)
+            key = encode_key(key);
+        store_bits(dst, offsets[(key >> shift) & RADIX_MASK]++,
+                decode ? decode_key(key) : key);
+    }
+}
+
+/* Same as radix_scatter() with decoding, but also records the starts of the
+ * runs of identical elements in the destination. The elements that the chunk
+ * writes into a bucket form a contiguous range of the destination, and the
+ * starts found in that range are stored in the run-length structure from the
+ * beginning of the range on; num_starts receives their number for each
+ * bucket. Each chunk only knows the preceding element if it wrote it itself,
+ * so the first element of each range is always recorded as a start, and must
+ * be checked against the end of the preceding range once all the chunks are
+ * done. */
+static void radix_scatter_and_find_runs(const void* src, double* dst, size_t from,
+        size_t to, int encode, unsigned int shift, size_t* offsets,
+        plfit_sorted_runs_t* runs, size_t* num_starts) {
+    double last[RADIX_SIZE];
+    size_t begin[RADIX_SIZE];
+    double x;
+    size_t i, b, pos;
+    uint64_t key;
+
+    memcpy(begin, offsets, sizeof(begin));
+    memset(num_starts, 0, sizeof(size_t) * RADIX_SIZE);
+
+    for (i = from; i < to; i++) {
+        key = load_bits(src, i);
+        if (encode)
+            key = encode_key(key);
+        b = (key >> shift) & RADIX_MASK;
+        key = decode_key(key);
+        memcpy(&x, &key, sizeof(x));
+
+        pos = offsets[b]++;
+        dst[pos] = x;
+        if (pos == begin[b] || x != last[b]) {
+            runs_set(runs, begin[b] + num_starts[b]++, pos);
+        }
+        last[b] = x;
+    }
+}
+
+int plfit_radix_sort_doubles(const double* xs, size_t n, double* result,
+        plfit_sorted_runs_t* runs) {
+    size_t num_chunks = 1, t, b, sum;
+    size_t *counts, *totals, *chunk_counts;
+    unsigned int digits[RADIX_NUM_DIGITS];
+    unsigned int num_digits, d, k;
+    uint64_t *scratch = NULL;
+    size_t *num_starts = NULL;
+    const void* src;
+    int retval = PLFIT_SUCCESS;
+    void* dst;
+    long int i = 0;
+
+    if (n == 0) {
+        return runs ? plfit_sorted_runs_init(runs, result, 0) : PLFIT_SUCCESS;
+    }
+
+#ifdef _OPENMP
+    num_chunks = n / RADIX_MIN_CHUNK_SIZE;
+    if (num_chunks > (size_t)omp_get_max_threads()) {
+        num_chunks = omp_get_max_threads();
+    }
+    if (num_chunks < 1) {
+        num_chunks = 1;
+    }
+#endif
+
+    /* counts[t][d][b] is the number of elements in chunk t whose digit d is
+     * equal to b; totals[d][b] is the same for the entire array */
+    counts = (size_t*)malloc(sizeof(size_t) * (num_chunks + 1) * RADIX_NUM_DIGITS * RADIX_SIZE);
+    if (counts == NULL) {
+        PLFIT_ERROR("cannot allocate counters for radix sort", PLFIT_ENOMEM);
+    }
+    totals = counts + num_chunks * RADIX_NUM_DIGITS * RADIX_SIZE;
+
+    /* Count all the digits of the input in a single pass */
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) if (num_chunks > 1)
+#endif
+    for (i = 0; i < (long int)num_chunks; i++) {
+        size_t from = n * i / num_chunks, to = n * (i + 1) / num_chunks, j;
+        size_t* chunk = counts + i * RADIX_NUM_DIGITS * RADIX_SIZE;
+        unsigned int digit;
+        uint64_t key;
+
+        memset(chunk, 0, sizeof(size_t) * RADIX_NUM_DIGITS * RADIX_SIZE);
+        for (j = from; j < to; j++) {
+            key = key_of(xs[j]);
+            for (digit = 0; digit < RADIX_NUM_DIGITS; digit++) {
+                chunk[digit * RADIX_SIZE + ((key >> (digit * RADIX_BITS)) & RADIX_MASK)]++;
+            }
+        }
+    }
+
+    /* Digits that are the same in every element need no pass at all. This
+     * happens often in practice; for instance, the low-order mantissa bits of
+     * integer-valued data are all zeros. */
+    num_digits = 0;
+    for (d = 0; d < RADIX_NUM_DIGITS; d++) {
+        size_t* total = totals + d * RADIX_SIZE;
+        int trivial = 0;
+
+        for (b = 0; b < RADIX_SIZE; b++) {
+            total[b] = 0;
+            for (t = 0; t < num_chunks; t++) {
+                total[b] += counts[(t * RADIX_NUM_DIGITS + d) * RADIX_SIZE + b];
+            }
+            if (total[b] == n) {
+                trivial = 1;
+            }
+        }
+
+        if (!trivial) {
+            digits[num_digits++] = d;
+        }
+    }
+
+    if (num_digits == 0) {
+        /* All the bit patterns are the same; the input is already sorted */
+        memcpy(result, xs, sizeof(double) * n);
+        free(counts);
+        return runs ? plfit_sorted_runs_init(runs, result, n) : PLFIT_SUCCESS;
+    }
+
+    if (num_digits > 1) {
+        scratch = (uint64_t*)malloc(sizeof(uint64_t) * n);
+        if (scratch == NULL) {
+            free(counts);
+            PLFIT_ERROR("cannot allocate temporary buffer for radix sort", PLFIT_ENOMEM);
+        }
+    }
+
+    if (runs) {
+        /* The final pass stores the starts of the runs directly in the
+         * run-length structure, which is allocated for the worst case of n
+         * runs and shrunk once the number of runs is known */
+        num_starts = (size_t*)malloc(sizeof(size_t) * num_chunks * RADIX_SIZE);
+        retval = num_starts ? runs_alloc(runs, n, n) : PLFIT_ENOMEM;
+        if (retval) {
+            if (num_starts)
+                plfit_sorted_runs_destroy(runs);
+            free(num_starts);
+            free(scratch);
+            free(counts);
+            PLFIT_ERROR("cannot allocate temporary buffer for radix sort", retval);
+        }
+    }
+
+    /* The passes alternate between the scratch buffer and the result such
+     * that the last pass writes the result. The first pass reads the input
+     * directly and the last one converts the keys back to doubles. */
+    src = xs;
+    for (k = 0; k < num_digits; k++) {
+        d = digits[k];
+        dst = ((num_digits - 1 - k) % 2 == 0) ? (void*)result : (void*)scratch;
+
+        /* Per-chunk counts of the first pass are known from the counting
+         * pass; later passes need fresh per-chunk counts because the elements
+         * have moved between chunks. A single chunk covers the entire array,
+         * so its counts do not change. */
+        if (k > 0 && num_chunks > 1) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+            for (i = 0; i < (long int)num_chunks; i++) {
+                radix_count(src, n * i / num_chunks, n * (i + 1) / num_chunks,
+                        d * RADIX_BITS, counts + (i * RADIX_NUM_DIGITS + d) * RADIX_SIZE);
+            }
+        }
+
+        /* Turn the counts into starting offsets. Elements with the same digit
+         * keep their relative order across chunks, which makes the sort
+         * stable. */
+        sum = 0;
+        for (b = 0; b < RADIX_SIZE; b++) {
+            for (t = 0; t < num_chunks; t++) {
+                chunk_counts = counts + (t * RADIX_NUM_DIGITS + d) * RADIX_SIZE;
+                sum += chunk_counts[b];
+                chunk_counts[b] = sum - chunk_counts[b];
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1) if (num_chunks > 1)
+#endif
+        for (i = 0; i < (long int)num_chunks; i++) {
+            if (runs && k == num_digits - 1) {
+                radix_scatter_and_find_runs(src, result, n * i / num_chunks,
+                        n * (i + 1) / num_chunks, k == 0, d * RADIX_BITS,
+                        counts + (i * RADIX_NUM_DIGITS + d) * RADIX_SIZE, runs,
+                        num_starts + i * RADIX_SIZE);
+            } else {
+                radix_scatter(src, dst, n * i / num_chunks, n * (i + 1) / num_chunks,
+                        k == 0, k == num_digits - 1, d * RADIX_BITS,
+                        counts + (i * RADIX_NUM_DIGITS + d) * RADIX_SIZE);
+            }
+        }
+
+        src = dst;
+    }
+
+    free(scratch);
+
+    if (runs) {
+        /* Move the starts of the runs from the beginning of each range to
+         * the front, dropping the first start of a range if it continues the
+         * run of the preceding range. The offsets now point to the end of the
+         * range of each chunk within each bucket, and these ranges follow
+         * each other in the order of the buckets and then the chunks, so the
+         * starts never move backwards. */
+        size_t from = 0, to, j, num_runs = 0;
+        for (b = 0; b < RADIX_SIZE; b++) {
+            for (t = 0; t < num_chunks; t++) {
+                to = counts[(t * RADIX_NUM_DIGITS + d) * RADIX_SIZE + b];
+                if (to > from) {
+                    j = (from > 0 && result[from] == result[from-1]) ? 1 : 0;
+                    for (; j < num_starts[t * RADIX_SIZE + b]; j++) {
+                        runs_set(runs, num_runs++, plfit_sorted_runs_start(runs, from + j));
+                    }
+                }
+                from = to;
+            }
+        }
+
+        runs_shrink(runs, n, num_runs);
+        free(num_starts);
+    }
+
+    free(counts);
+
+    return retval;
+}
+
+int plfit_sort_doubles(const double* xs, size_t n, double* result,
+        plfit_sorted_runs_t* runs) {
+    if (n < PLFIT_SORT_RADIX_THRESHOLD) {
+        memcpy(result, xs, sizeof(double) * n);
+        plfit_introsort_doubles(result, n);
+        return runs ? plfit_sorted_runs_init(runs, result, n) : PLFIT_SUCCESS;
+    }
+
+    return plfit_radix_sort_doubles(xs, n, result, runs);
+}
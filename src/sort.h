@@ -0,0 +1,133 @@
+/* sort.h
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __SORT_H__
+#define __SORT_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "plfit_decls.h"
+
+__BEGIN_DECLS
+
+/**
+ * Arrays shorter than this are sorted with an introsort instead of the
+ * radix sort in \ref plfit_sort_doubles().
+ */
+#define PLFIT_SORT_RADIX_THRESHOLD 2048
+
+/**
+ * Run-length structure of a sorted array, i.e. the start offsets of the
+ * blocks of identical elements.
+ *
+ * Offsets are stored in 32 bits if the array has less than 2^32 elements and
+ * in 64 bits otherwise; exactly one of \c starts32 and \c starts64 is not
+ * \c NULL. Both have a guard element at index \c num_runs that is equal to
+ * the length of the array, so the length of run \c i is always
+ * <code>start(i+1) - start(i)</code>. Use \ref plfit_sorted_runs_start() to
+ * access the offsets.
+ */
+typedef struct {
+    size_t num_runs;       /**< Number of runs, i.e. distinct values */
+    uint32_t* starts32;    /**< Start offsets of the runs for short arrays */
+    uint64_t* starts64;    /**< Start offsets of the runs for long arrays */
+} plfit_sorted_runs_t;
+
+/**
+ * Finds the runs of identical elements in a sorted array.
+ *
+ * Two elements belong to the same run if they compare equal with the \c ==
+ * operator; in particular, positive and negative zeros form a single run.
+ *
+ * \param  runs    the run structure to initialize
+ * \param  xs      the sorted array
+ * \param  n       the number of elements in the array
+ *
+ * \return \c PLFIT_SUCCESS or \c PLFIT_ENOMEM
+ */
+int plfit_sorted_runs_init(plfit_sorted_runs_t* runs, const double* xs, size_t n);
+
+/**
+ * Releases the memory used by a run structure.
+ */
+void plfit_sorted_runs_destroy(plfit_sorted_runs_t* runs);
+
+/**
+ * Returns the start offset of the given run. \c i may also be equal to the
+ * number of runs; the length of the array is returned in this case.
+ */
+static inline size_t plfit_sorted_runs_start(const plfit_sorted_runs_t* runs, size_t i) {
+    return runs->starts32 ? runs->starts32[i] : (size_t)runs->starts64[i];
+}
+
+/**
+ * Sorts an array of doubles into another array in increasing order.
+ *
+ * Long arrays are sorted with an LSD radix sort on the IEEE 754 bit patterns,
+ * which is parallelized with OpenMP if it is enabled. Short arrays are
+ * sorted with an introsort. Both methods order the values by the same total
+ * order: negative zero precedes positive zero, and NaNs are placed at the
+ * beginning or at the end depending on their sign bit. Equal values are
+ * always adjacent in the result.
+ *
+ * The run-length structure of the result can be requested at the same time;
+ * the radix sort then records the run boundaries during its final pass so
+ * the sorted array does not have to be scanned again.
+ *
+ * \param  xs      the array to sort
+ * \param  n       the number of elements in the array
+ * \param  result  the sorted array is returned here. It must have room for
+ *                 \c n elements and it must not overlap with \c xs.
+ * \param  runs    if not \c NULL, the run-length structure of the sorted
+ *                 array is returned here. It must be destroyed with
+ *                 \ref plfit_sorted_runs_destroy() when no longer needed.
+ *
+ * \return \c PLFIT_SUCCESS or \c PLFIT_ENOMEM if there is not enough memory
+ *         for the temporary buffers of the radix sort
+ */
+int plfit_sort_doubles(const double* xs, size_t n, double* result,
+        plfit_sorted_runs_t* runs);
+
+/**
+ * Sorts an array of doubles into another array using an LSD radix sort,
+ * regardless of the length of the array.
+ *
+ * \param  xs      the array to sort
+ * \param  n       the number of elements in the array
+ * \param  result  the sorted array is returned here. It must have room for
+ *                 \c n elements and it must not overlap with \c xs.
+ * \param  runs    if not \c NULL, the run-length structure of the sorted
+ *                 array is returned here
+ *
+ * \return \c PLFIT_SUCCESS or \c PLFIT_ENOMEM
+ */
+int plfit_radix_sort_doubles(const double* xs, size_t n, double* result,
+        plfit_sorted_runs_t* runs);
+
+/**
+ * Sorts an array of doubles in place using an introsort.
+ *
+ * \param  xs      the array to sort
+ * \param  n       the number of elements in the array
+ */
+void plfit_introsort_doubles(double* xs, size_t n);
+
+__END_DECLS
+
+#endif /* __SORT_H__ */
@@ -0,0 +1,148 @@
+/* test_checkpoint.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <plfit.h>
+#include "checkpoint.h"
+
+#include "test_common.h"
+
+#define CHECKPOINT_FILE "test_checkpoint.state"
+
+double data[10000];
+
+int test_checkpoint_file() {
+    plfit_p_value_checkpoint_t checkpoint, loaded;
+    plfit_bool_t found;
+
+    remove(CHECKPOINT_FILE);
+    ASSERT_SUCCESSFUL(plfit_p_value_checkpoint_read(CHECKPOINT_FILE, &loaded, &found));
+    ASSERT_ZERO(found);
+
+    checkpoint.kind = 'D';
+    checkpoint.n = 10000;
+    checkpoint.xmin = 2;
+    checkpoint.alpha = 2.0 / 3.0 + 2;
+    checkpoint.D = 0.1;
+    checkpoint.precision = 0.01;
+    checkpoint.threshold = 0;
+    checkpoint.xmin_fixed = 1;
+    checkpoint.stream_key = 0xFEDCBA9876543210ULL;
+    checkpoint.num_trials = 640;
+    checkpoint.successes = 123;
+    checkpoint.num_checks = 10;
+    checkpoint.stopped = 0;
+
+    /* Every field survives a round trip exactly */
+    ASSERT_SUCCESSFUL(plfit_p_value_checkpoint_write(CHECKPOINT_FILE, &checkpoint));
+    ASSERT_SUCCESSFUL(plfit_p_value_checkpoint_read(CHECKPOINT_FILE, &loaded, &found));
+    ASSERT_NONZERO(found);
+    ASSERT_NONZERO(plfit_p_value_checkpoint_matches(&checkpoint, &loaded));
+    ASSERT_EQUAL(loaded.alpha, checkpoint.alpha);
+    ASSERT_NONZERO(loaded.stream_key == checkpoint.stream_key);
+    ASSERT_EQUAL(loaded.num_trials, 640);
+    ASSERT_EQUAL(loaded.successes, 123);
+    ASSERT_EQUAL(loaded.num_checks, 10);
+    ASSERT_ZERO(loaded.stopped);
+
+    /* Checkpoints of other calculations do not match */
+    loaded.alpha = 2.5;
+    ASSERT_ZERO(plfit_p_value_checkpoint_matches(&checkpoint, &loaded));
+
+    remove(CHECKPOINT_FILE);
+
+    return 0;
+}
+
+int test_resume_p_value() {
+    plfit_result_t result, expected;
+    plfit_discrete_options_t options;
+    plfit_p_value_checkpoint_t checkpoint;
+    plfit_mt_rng_t rng;
+    plfit_bool_t found;
+    size_t n;
+
+    plfit_discrete_options_init(&options);
+    options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+    n = test_read_file("discrete_data.txt", data, 10000);
+    ASSERT_NONZERO(n);
+    ASSERT_SUCCESSFUL(plfit_estimate_alpha_discrete(data, n, 2, &options, &expected));
+    result = expected;
+
+    options.p_value_method = PLFIT_P_VALUE_EXACT;
+    options.rng = &rng;
+
+    /* The first 64 trials of the calculation below, without a checkpoint */
+    options.p_value_precision = 0.0625;
+    plfit_mt_init_from_stream(&rng, 42, 0);
+    ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete(data, n, &options, 1, &result));
+    ASSERT_EQUAL(result.num_trials, 64);
+
+    /* Pretend that a calculation of 400 trials was interrupted after these */
+    checkpoint.kind = 'D';
+    checkpoint.n = n;
+    checkpoint.xmin = expected.xmin;
+    checkpoint.alpha = expected.alpha;
+    checkpoint.D = expected.D;
+    checkpoint.precision = 0.025;
+    checkpoint.threshold = 0;
+    checkpoint.xmin_fixed = 1;
+    plfit_mt_init_from_stream(&rng, 42, 0);
+    checkpoint.stream_key = ((uint64_t) plfit_mt_random(&rng)) << 32;
+    checkpoint.stream_key |= plfit_mt_random(&rng);
+    checkpoint.num_trials = 64;
+    checkpoint.successes = (long int) (result.p * 64 + 0.5);
+    checkpoint.num_checks = 1;
+    checkpoint.stopped = 0;
+    ASSERT_SUCCESSFUL(plfit_p_value_checkpoint_write(CHECKPOINT_FILE, &checkpoint));
+
+    /* The uninterrupted calculation */
+    options.p_value_precision = 0.025;
+    plfit_mt_init_from_stream(&rng, 42, 0);
+    ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete(data, n, &options, 1, &expected));
+    ASSERT_EQUAL(expected.num_trials, 400);
+
+    /* Resuming gives the same result even if the RNG is seeded differently */
+    options.p_value_checkpoint = CHECKPOINT_FILE;
+    plfit_mt_init_from_stream(&rng, 43, 0);
+    ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete(data, n, &options, 1, &result));
+    ASSERT_EQUAL(result.num_trials, 400);
+    ASSERT_EQUAL(result.p, expected.p);
+
+    ASSERT_SUCCESSFUL(plfit_p_value_checkpoint_read(CHECKPOINT_FILE, &checkpoint, &found));
+    ASSERT_NONZERO(found);
+    ASSERT_EQUAL(checkpoint.num_trials, 400);
+
+    /* A checkpoint of a different calculation is rejected */
+    plfit_set_error_handler(plfit_error_handler_ignore);
+    options.p_value_precision = 0.05;
+    ASSERT_EQUAL(plfit_calculate_p_value_discrete(data, n, &options, 1, &result),
+            PLFIT_EINVAL);
+
+    remove(CHECKPOINT_FILE);
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    RUN_TEST_CASE(test_checkpoint_file, "reading and writing checkpoints");
+    RUN_TEST_CASE(test_resume_p_value, "resuming an exact p-value calculation");
+    return 0;
+}
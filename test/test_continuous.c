@@ -22,8 +22,9 @@
 #include "test_common.h"
 
 int test_continuous() {
-	plfit_result_t result;
+	plfit_result_t result, expected;
 	plfit_continuous_options_t options;
+	plfit_mt_rng_t rng;
 	double data[10000];
 	size_t n;
 
@@ -48,6 +49,46 @@ int test_continuous() {
 	ASSERT_ALMOST_EQUAL(result.alpha, 2.53282, 1e-4);
 	ASSERT_ALMOST_EQUAL(result.L, -9276.42, 1e-1);
 
+	options.xmin_method = PLFIT_LINEAR_ONLY;
+	plfit_continuous(data, n, &options, &expected);
+
+	options.xmin_method = PLFIT_HIERARCHICAL_SAMPLING;
+	result.alpha = result.xmin = result.L = 0;
+	plfit_continuous(data, n, &options, &result);
+	ASSERT_ALMOST_EQUAL(result.xmin, 1.43628, 1e-4);
+	ASSERT_ALMOST_EQUAL(result.alpha, 2.53282, 1e-4);
+	ASSERT_ALMOST_EQUAL(result.L, -9276.42, 1e-1);
+
+	/* Zero tolerance gives the exhaustive result even if only the best
+	 * stratum is refined on each level */
+	options.hierarchical.keep = 1;
+	options.hierarchical.tolerance = 0;
+	plfit_continuous(data, n, &options, &result);
+	ASSERT_EQUAL(result.xmin, expected.xmin);
+	ASSERT_EQUAL(result.alpha, expected.alpha);
+	ASSERT_EQUAL(result.D, expected.D);
+
+	/* Other tolerances bound the excess of D */
+	options.hierarchical.tolerance = 0.01;
+	plfit_continuous(data, n, &options, &result);
+	ASSERT_WITHIN_RANGE(result.D, expected.D, expected.D + 0.01);
+
+	/* Exact p-values from the synthetic datasets, which are generated in
+	 * sorted order */
+	plfit_continuous_options_init(&options);
+	options.p_value_precision = 0.05;
+	options.rng = &rng;
+
+	plfit_mt_init_from_stream(&rng, 42, 0);
+	plfit_estimate_alpha_continuous(data, n, 1.43628, &options, &result);
+	ASSERT_EQUAL(result.num_trials, 100);
+	ASSERT_WITHIN_RANGE(result.p, 0.6, 1);
+
+	plfit_mt_init_from_stream(&rng, 42, 0);
+	plfit_continuous(data, n, &options, &result);
+	ASSERT_EQUAL(result.num_trials, 100);
+	ASSERT_WITHIN_RANGE(result.p, 0.1, 0.8);
+
 	return 0;
 }
 
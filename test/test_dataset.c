@@ -0,0 +1,214 @@
+/* test_dataset.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <plfit.h>
+
+#include "test_common.h"
+
+double data[10000];
+
+int test_continuous_dataset() {
+	plfit_result_t result, expected;
+	plfit_continuous_options_t options;
+	plfit_dataset_t dataset;
+	size_t n;
+	double L;
+
+	plfit_continuous_options_init(&options);
+	options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+	n = test_read_file("continuous_data.txt", data, 10000);
+	ASSERT_NONZERO(n);
+
+	ASSERT_SUCCESSFUL(plfit_dataset_init(&dataset, data, n));
+	ASSERT_EQUAL(dataset.n, n);
+
+	/* Fit the same dataset several times with different settings */
+	plfit_continuous(data, n, &options, &expected);
+	ASSERT_SUCCESSFUL(plfit_continuous_dataset(&dataset, &options, &result));
+	ASSERT_EQUAL(result.xmin, expected.xmin);
+	ASSERT_ALMOST_EQUAL(result.alpha, expected.alpha, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.D, expected.D, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.L, expected.L, 1e-6);
+
+	options.finite_size_correction = 1;
+	plfit_continuous(data, n, &options, &expected);
+	ASSERT_SUCCESSFUL(plfit_continuous_dataset(&dataset, &options, &result));
+	ASSERT_EQUAL(result.xmin, expected.xmin);
+	ASSERT_ALMOST_EQUAL(result.alpha, expected.alpha, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.L, expected.L, 1e-6);
+
+	options.finite_size_correction = 0;
+	plfit_estimate_alpha_continuous(data, n, 1.43628, &options, &expected);
+	ASSERT_SUCCESSFUL(plfit_estimate_alpha_continuous_dataset(&dataset, 1.43628,
+				&options, &result));
+	ASSERT_ALMOST_EQUAL(result.alpha, 2.53282, 1e-4);
+	ASSERT_ALMOST_EQUAL(result.alpha, expected.alpha, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.D, expected.D, 1e-8);
+
+	ASSERT_SUCCESSFUL(plfit_log_likelihood_continuous_dataset(&dataset, 2.53282,
+				1.43628, &L));
+	ASSERT_ALMOST_EQUAL(L, -9276.42, 1e-1);
+
+	options.p_value_method = PLFIT_P_VALUE_APPROXIMATE;
+	expected = result;
+	plfit_calculate_p_value_continuous(data, n, &options, 1, &expected);
+	ASSERT_SUCCESSFUL(plfit_calculate_p_value_continuous_dataset(&dataset, &options,
+				1, &result));
+	ASSERT_ALMOST_EQUAL(result.p, expected.p, 1e-8);
+
+	plfit_dataset_destroy(&dataset);
+
+	return 0;
+}
+
+int test_discrete_dataset() {
+	plfit_result_t result, expected;
+	plfit_discrete_options_t options;
+	plfit_dataset_t dataset;
+	size_t n;
+	double L;
+
+	plfit_discrete_options_init(&options);
+	options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+	n = test_read_file("discrete_data.txt", data, 10000);
+	ASSERT_NONZERO(n);
+
+	ASSERT_SUCCESSFUL(plfit_dataset_init(&dataset, data, n));
+
+	plfit_discrete(data, n, &options, &expected);
+	ASSERT_SUCCESSFUL(plfit_discrete_dataset(&dataset, &options, &result));
+	ASSERT_EQUAL(result.xmin, expected.xmin);
+	ASSERT_ALMOST_EQUAL(result.alpha, expected.alpha, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.D, expected.D, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.L, expected.L, 1e-6);
+
+	options.alpha_method = PLFIT_PRETEND_CONTINUOUS;
+	plfit_estimate_alpha_discrete(data, n, 2, &options, &expected);
+	ASSERT_SUCCESSFUL(plfit_estimate_alpha_discrete_dataset(&dataset, 2, &options,
+				&result));
+	ASSERT_ALMOST_EQUAL(result.alpha, expected.alpha, 1e-8);
+	ASSERT_ALMOST_EQUAL(result.D, expected.D, 1e-8);
+
+	ASSERT_SUCCESSFUL(plfit_log_likelihood_discrete_dataset(&dataset, 2.58, 2, &L));
+	ASSERT_ALMOST_EQUAL(L, -9155.62809, 1e-4);
+
+	plfit_dataset_destroy(&dataset);
+
+	return 0;
+}
+
+int test_exact_p_value_streams() {
+	plfit_result_t result;
+	plfit_discrete_options_t options;
+	plfit_dataset_t dataset;
+	plfit_mt_rng_t rng, other_rng;
+	size_t n;
+	uint32_t x, y;
+	double p;
+
+	plfit_discrete_options_init(&options);
+	options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+	n = test_read_file("discrete_data.txt", data, 10000);
+	ASSERT_NONZERO(n);
+	ASSERT_SUCCESSFUL(plfit_dataset_init(&dataset, data, n));
+	ASSERT_SUCCESSFUL(plfit_estimate_alpha_discrete_dataset(&dataset, 2, &options,
+				&result));
+
+	/* Streams depend only on the key and the stream index */
+	plfit_mt_init_from_stream(&rng, 42, 7);
+	plfit_mt_init_from_stream(&other_rng, 42, 7);
+	x = plfit_mt_random(&rng);
+	y = plfit_mt_random(&other_rng);
+	ASSERT_EQUAL(x, y);
+	plfit_mt_init_from_stream(&other_rng, 42, 8);
+	x = plfit_mt_random(&rng);
+	y = plfit_mt_random(&other_rng);
+	ASSERT_NONZERO(x != y);
+
+	/* The exact p-value only depends on the state of the master RNG */
+	options.p_value_method = PLFIT_P_VALUE_EXACT;
+	options.p_value_precision = 0.1;
+	options.rng = &rng;
+
+	plfit_mt_init_from_stream(&rng, 42, 0);
+	ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete_dataset(&dataset, &options,
+				1, &result));
+	p = result.p;
+	ASSERT_WITHIN_RANGE(p, 0, 1);
+
+	plfit_mt_init_from_stream(&rng, 42, 0);
+	ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete_dataset(&dataset, &options,
+				1, &result));
+	ASSERT_EQUAL(result.p, p);
+
+	plfit_dataset_destroy(&dataset);
+
+	return 0;
+}
+
+int test_sequential_p_value() {
+	plfit_result_t result;
+	plfit_discrete_options_t options;
+	plfit_dataset_t dataset;
+	plfit_mt_rng_t rng;
+	size_t n;
+
+	plfit_discrete_options_init(&options);
+	options.p_value_method = PLFIT_P_VALUE_SKIP;
+
+	n = test_read_file("discrete_data.txt", data, 10000);
+	ASSERT_NONZERO(n);
+	ASSERT_SUCCESSFUL(plfit_dataset_init(&dataset, data, n));
+	ASSERT_SUCCESSFUL(plfit_estimate_alpha_discrete_dataset(&dataset, 2, &options,
+				&result));
+	ASSERT_EQUAL(result.num_trials, 0);
+
+	options.p_value_method = PLFIT_P_VALUE_EXACT;
+	options.p_value_precision = 0.025;
+	options.rng = &rng;
+
+	/* All the trials are used without a threshold */
+	plfit_mt_init_from_stream(&rng, 42, 0);
+	ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete_dataset(&dataset, &options,
+				1, &result));
+	ASSERT_EQUAL(result.num_trials, 400);
+
+	/* The p-value of this dataset is far above 0.1 so a few trials suffice */
+	options.p_value_threshold = 0.1;
+	plfit_mt_init_from_stream(&rng, 42, 0);
+	ASSERT_SUCCESSFUL(plfit_calculate_p_value_discrete_dataset(&dataset, &options,
+				1, &result));
+	ASSERT_WITHIN_RANGE(result.num_trials, 1, 399);
+	ASSERT_WITHIN_RANGE(result.p, 0.1, 1);
+
+	plfit_dataset_destroy(&dataset);
+
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	RUN_TEST_CASE(test_continuous_dataset, "continuous fits on a prepared dataset");
+	RUN_TEST_CASE(test_discrete_dataset, "discrete fits on a prepared dataset");
+	RUN_TEST_CASE(test_exact_p_value_streams, "reproducible exact p-values");
+	RUN_TEST_CASE(test_sequential_p_value, "exact p-values with early stopping");
+	return 0;
+}
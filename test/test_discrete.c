@@ -22,7 +22,7 @@
 #include "test_common.h"
 
 int test_discrete() {
-	plfit_result_t result;
+	plfit_result_t result, expected;
 	plfit_discrete_options_t options;
 	double data[10000];
 	size_t n;
@@ -50,6 +50,18 @@ int test_discrete() {
 	plfit_estimate_alpha_discrete(data, n, result.xmin, &options, &result);
 	ASSERT_ALMOST_EQUAL(result.alpha, 2.58, 1e-1);
 
+	expected = result;
+	result.alpha = 0;
+	options.alpha_method = PLFIT_NEWTON;
+	plfit_estimate_alpha_discrete(data, n, result.xmin, &options, &result);
+	ASSERT_ALMOST_EQUAL(result.alpha, expected.alpha, 1e-6);
+
+	result.alpha = result.xmin = result.L = 0;
+	plfit_discrete(data, n, &options, &result);
+	ASSERT_ALMOST_EQUAL(result.alpha, 2.5833, 1e-4);
+	ASSERT_EQUAL(result.xmin, 2);
+	ASSERT_ALMOST_EQUAL(result.L, -9155.617067, 1e-4);
+
 	result.alpha = result.xmin = result.L = 0;
 	options.alpha_method = PLFIT_LINEAR_SCAN;
 	options.alpha.min = 1.01;
@@ -17,7 +17,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <float.h>
 #include "hzeta.h"
+#include "plfit_error.h"
 
 #include "test_common.h"
 
@@ -30,9 +32,126 @@ int test_hsl_sf_lnhzeta() {
     return 0;
 }
 
+int test_hsl_sf_lnhzeta_batch() {
+    const double ss[] = { 1.01, 1.5, 2.58, 3.7, 8.0, 25.0 };
+    double qs[300], out[300];
+    size_t i, j, n = sizeof(qs) / sizeof(qs[0]);
+
+    /* Mixes values of q that take the batched path with ones that do not */
+    for (i = 0; i < n; i++) {
+        qs[i] = (i % 3 == 0) ? 1 + i : 0.5 + 7.3 * i;
+    }
+
+    for (j = 0; j < sizeof(ss) / sizeof(ss[0]); j++) {
+        ASSERT_SUCCESSFUL(hsl_sf_lnhzeta_batch(ss[j], qs, n, out));
+        for (i = 0; i < n; i++) {
+            double expected = hsl_sf_lnhzeta(ss[j], qs[i]);
+            double tolerance = 1e-13 * fabs(expected) + 1e-15;
+            ASSERT_ALMOST_EQUAL(out[i], expected, tolerance);
+        }
+    }
+
+    /* Empty input */
+    ASSERT_SUCCESSFUL(hsl_sf_lnhzeta_batch(2.5, qs, 0, out));
+
+    return 0;
+}
+
+int test_hsl_sf_lnhzeta_multi() {
+    const double qs[] = { 0.5, 1, 2, 7.5, 48, 1000 };
+    double ss[400], out[400];
+    size_t i, j, n = sizeof(ss) / sizeof(ss[0]);
+
+    /* The default alpha grid of the linear scan */
+    for (i = 0; i < n; i++) {
+        ss[i] = 1.01 + 0.01 * i;
+    }
+
+    for (j = 0; j < sizeof(qs) / sizeof(qs[0]); j++) {
+        ASSERT_SUCCESSFUL(hsl_sf_lnhzeta_multi(ss, n, qs[j], out));
+        for (i = 0; i < n; i++) {
+            ASSERT_EQUAL(out[i], hsl_sf_lnhzeta(ss[i], qs[j]));
+        }
+    }
+
+    return 0;
+}
+
+int test_hsl_sf_lnhzeta_asymptotic() {
+    const double ss[] = { 1.001, 1.01, 1.5, 2.0, 2.58, 3.7, 8.0, 25.0 };
+    double q, value, deriv, series_value, series_deriv, tolerance;
+    size_t j;
+
+    /* Covers q below, around and far above the switch-over point */
+    for (j = 0; j < sizeof(ss) / sizeof(ss[0]); j++) {
+        for (q = 1.5; q < 1e10; q *= 1.37) {
+            hsl_sf_lnhzeta_deriv_tuple(ss[j], q, &value, &deriv);
+            hsl_sf_lnhzeta_deriv_tuple_series(ss[j], q, &series_value, &series_deriv);
+
+            tolerance = 4 * DBL_EPSILON * fabs(series_value);
+            ASSERT_ALMOST_EQUAL(value, series_value, tolerance);
+            tolerance = 4 * DBL_EPSILON * fabs(series_deriv);
+            ASSERT_ALMOST_EQUAL(deriv, series_deriv, tolerance);
+
+            ASSERT_EQUAL(hsl_sf_lnhzeta(ss[j], q), value);
+            ASSERT_EQUAL(hsl_sf_lnhzeta_deriv(ss[j], q), deriv);
+        }
+    }
+
+    return 0;
+}
+
+int test_hsl_sf_lnhzeta_cache() {
+    double value, deriv, value2, deriv2;
+    size_t hits, misses;
+
+    hsl_sf_lnhzeta_cache_reset();
+    value = hsl_sf_lnhzeta(2.58, 3);
+    deriv = hsl_sf_lnhzeta_deriv(2.58, 3);
+    value2 = hsl_sf_lnhzeta_deriv_tuple(2.58, 3, &value2, &deriv2);
+    ASSERT_EQUAL(value2, value);
+    ASSERT_EQUAL(deriv2, deriv);
+    ASSERT_EQUAL(hsl_sf_lnhzeta(2.58, 3.5), hsl_sf_lnhzeta_deriv_tuple_series(2.58, 3.5, &value2, &deriv2));
+    ASSERT_EQUAL(hsl_sf_lnhzeta(2.58, 3.5), value2);
+    hsl_sf_lnhzeta_cache_stats(&hits, &misses);
+
+#ifdef USE_HZETA_CACHE
+    /* The derivative is not known after the first call, but the tuple is
+     * complete after the second one */
+    ASSERT_EQUAL(hits, 2);
+    ASSERT_EQUAL(misses, 3);
+#else
+    ASSERT_EQUAL(hits, 0);
+    ASSERT_EQUAL(misses, 0);
+#endif
+
+    hsl_sf_lnhzeta_cache_reset();
+    hsl_sf_lnhzeta_cache_stats(&hits, &misses);
+    ASSERT_EQUAL(hits, 0);
+    ASSERT_EQUAL(misses, 0);
+
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     RUN_TEST_CASE(
         test_hsl_sf_lnhzeta,
         "lnhzeta() calculation smoke test"
     );
+    RUN_TEST_CASE(
+        test_hsl_sf_lnhzeta_batch,
+        "batched lnhzeta() agrees with the scalar version"
+    );
+    RUN_TEST_CASE(
+        test_hsl_sf_lnhzeta_multi,
+        "lnhzeta() for many s agrees with the scalar version"
+    );
+    RUN_TEST_CASE(
+        test_hsl_sf_lnhzeta_asymptotic,
+        "large-q asymptotic lnhzeta() agrees with the series"
+    );
+    RUN_TEST_CASE(
+        test_hsl_sf_lnhzeta_cache,
+        "lnhzeta() cache statistics"
+    );
 }
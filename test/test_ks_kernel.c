@@ -0,0 +1,182 @@
+/* test_ks_kernel.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <float.h>
+#include "ks_kernel.h"
+
+#include "test_common.h"
+
+#define MAX_N 1037
+
+double xs[MAX_N];
+double log_xs[MAX_N];
+
+/* Fills xs and log_xs with a sorted, slightly perturbed set of quantiles of
+ * a Pareto distribution */
+static void fill_sample(size_t n, double xmin, double alpha) {
+    size_t i;
+    for (i = 0; i < n; i++) {
+        double u = (i + 0.5 + 0.4 * sin(i * 12.9898)) / n;
+        xs[i] = xmin * pow(1 - u, -1.0 / (alpha - 1));
+        log_xs[i] = log(xs[i]);
+    }
+}
+
+/* Straightforward evaluation of the KS distance with pow() */
+static double naive_distance(size_t n, double alpha, double xmin) {
+    double result = 0, d;
+    size_t i;
+    for (i = 0; i < n; i++) {
+        d = fabs(1 - pow(xmin / xs[i], alpha - 1) - i / (double)n);
+        if (d > result)
+            result = d;
+    }
+    return result;
+}
+
+int test_kernels_agree() {
+    const size_t ns[] = { 0, 1, 3, 4, 7, 8, 9, 17, 100, 1000, MAX_N };
+    const double alphas[] = { 1.2, 2.5, 3.7, 60.0 };
+    const plfit_ks_kernel_t kernels[] = {
+        PLFIT_KS_KERNEL_SCALAR, PLFIT_KS_KERNEL_AVX2, PLFIT_KS_KERNEL_AVX512
+    };
+    size_t i, j, k;
+    double xmin = 1.5, expected, observed;
+
+    for (i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        for (j = 0; j < sizeof(alphas) / sizeof(alphas[0]); j++) {
+            fill_sample(ns[i], xmin, 2.5);
+            expected = naive_distance(ns[i], alphas[j], xmin);
+
+            for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+                if (!plfit_ks_kernel_available(kernels[k]))
+                    continue;
+
+                observed = plfit_ks_distance_continuous_with_kernel(kernels[k],
+                        log_xs, ns[i], alphas[j] - 1, log(xmin), DBL_MAX);
+                ASSERT_ALMOST_EQUAL(observed, expected, 1e-12);
+            }
+
+            observed = plfit_ks_distance_continuous(log_xs, ns[i], alphas[j] - 1, log(xmin), DBL_MAX);
+            ASSERT_ALMOST_EQUAL(observed, expected, 1e-12);
+        }
+    }
+
+    return 0;
+}
+
+int test_kernels_cutoff() {
+    const plfit_ks_kernel_t kernels[] = {
+        PLFIT_KS_KERNEL_SCALAR, PLFIT_KS_KERNEL_AVX2, PLFIT_KS_KERNEL_AVX512
+    };
+    size_t k;
+    double xmin = 1.5, alpha = 3.7, expected, observed;
+
+    fill_sample(MAX_N, xmin, 2.5);
+    expected = naive_distance(MAX_N, alpha, xmin);
+
+    for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!plfit_ks_kernel_available(kernels[k]))
+            continue;
+
+        /* A cutoff above the true distance must not change the result */
+        observed = plfit_ks_distance_continuous_with_kernel(kernels[k],
+                log_xs, MAX_N, alpha - 1, log(xmin), expected + 1e-9);
+        ASSERT_ALMOST_EQUAL(observed, expected, 1e-12);
+
+        /* A cutoff below the true distance must yield a value above the cutoff */
+        observed = plfit_ks_distance_continuous_with_kernel(kernels[k],
+                log_xs, MAX_N, alpha - 1, log(xmin), expected / 2);
+        ASSERT_WITHIN_RANGE(observed, expected / 2 + 1e-15, expected + 1e-12);
+    }
+
+    return 0;
+}
+
+int test_kernels_skip_nan() {
+    const size_t ns[] = { 2, 4, 5, 8, 9, 17, 100 };
+    const plfit_ks_kernel_t kernels[] = {
+        PLFIT_KS_KERNEL_SCALAR, PLFIT_KS_KERNEL_AVX2, PLFIT_KS_KERNEL_AVX512
+    };
+    size_t i, k;
+    double xmin = 1.5, expected, observed;
+
+    for (i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        fill_sample(ns[i], xmin, 2.5);
+        log_xs[0] = log(xmin);
+
+        /* With an infinite exponent, the first element yields inf * 0 = NaN,
+         * which must be skipped; the CDF is one for all the others */
+        expected = 1 - 1.0 / ns[i];
+        for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+            if (!plfit_ks_kernel_available(kernels[k]))
+                continue;
+
+            observed = plfit_ks_distance_continuous_with_kernel(kernels[k],
+                    log_xs, ns[i], INFINITY, log(xmin), DBL_MAX);
+            ASSERT_ALMOST_EQUAL(observed, expected, 1e-12);
+        }
+    }
+
+    return 0;
+}
+
+int test_blocked_distance() {
+    const size_t ns[] = { 0, 1, 2, 3, 9, 100, 129, 1000, MAX_N };
+    const double alphas[] = { 1.2, 2.5, 3.7, 60.0 };
+    size_t i, j;
+    double xmin = 1.5, expected, observed;
+
+    for (i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        for (j = 0; j < sizeof(alphas) / sizeof(alphas[0]); j++) {
+            fill_sample(ns[i], xmin, 2.5);
+
+            /* Skipping blocks must not change the result at all */
+            expected = plfit_ks_distance_continuous_with_kernel(PLFIT_KS_KERNEL_SCALAR,
+                    log_xs, ns[i], alphas[j] - 1, log(xmin), DBL_MAX);
+            observed = plfit_ks_distance_continuous_blocked(log_xs, ns[i],
+                    alphas[j] - 1, log(xmin), DBL_MAX);
+            ASSERT_EQUAL(observed, expected);
+
+            if (expected > 0) {
+                observed = plfit_ks_distance_continuous_blocked(log_xs, ns[i],
+                        alphas[j] - 1, log(xmin), expected / 2);
+                ASSERT_WITHIN_RANGE(observed, expected / 2 + 1e-15, expected + 1e-12);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int test_kernel_selection() {
+    ASSERT_NONZERO(plfit_ks_kernel_available(PLFIT_KS_KERNEL_SCALAR));
+    ASSERT_NONZERO(plfit_ks_kernel_available(plfit_ks_kernel_best()));
+    printf("Best available kernel: %d\n", (int)plfit_ks_kernel_best());
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    RUN_TEST_CASE(test_kernel_selection, "KS kernel selection");
+    RUN_TEST_CASE(test_kernels_agree, "KS kernels agree with each other");
+    RUN_TEST_CASE(test_kernels_cutoff, "KS kernels stop early at the cutoff");
+    RUN_TEST_CASE(test_kernels_skip_nan, "KS kernels skip NaN distances");
+    RUN_TEST_CASE(test_blocked_distance, "block-bounded KS distance");
+    return 0;
+}
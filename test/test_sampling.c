@@ -94,6 +94,49 @@ int test_sampling(void) {
     return 0;
 }
 
+int test_rbinom_state(void) {
+    plfit_rbinom_state_t state, other_state;
+    plfit_mt_rng_t rng, other_rng;
+    double x, y, sum, eps;
+    long int i;
+
+    /* The mean is 6 (inversion) in the first round and 300 (BTPE) in the
+     * second */
+    const double ns[] = { 30, 1000 };
+    const double ps[] = { 0.2, 0.7 };
+    int j;
+
+    for (j = 0; j < 2; j++) {
+        plfit_rbinom_state_init(&state);
+        plfit_mt_init_from_stream(&rng, 1, j);
+        sum = 0;
+        for (i = 0; i < 10000; i++) {
+            x = plfit_rbinom_state_sample(&state, ns[j], ps[j], &rng);
+            ASSERT_WITHIN_RANGE(x, 0, ns[j]);
+            sum += x;
+        }
+        eps = ns[j] * ps[j] * 0.02;
+        ASSERT_ALMOST_EQUAL(sum / 10000, ns[j] * ps[j], eps);
+    }
+
+    /* Interleaving draws with different parameters on two states gives the
+     * same values as the shared state of plfit_rbinom() */
+    plfit_rbinom_state_init(&state);
+    plfit_rbinom_state_init(&other_state);
+    plfit_mt_init_from_stream(&rng, 2, 0);
+    plfit_mt_init_from_stream(&other_rng, 2, 0);
+    for (i = 0; i < 100; i++) {
+        x = plfit_rbinom_state_sample(i % 2 ? &state : &other_state,
+                ns[i % 2], ps[i % 2], &rng);
+        y = plfit_rbinom(ns[i % 2], ps[i % 2], &other_rng);
+        ASSERT_EQUAL(x, y);
+    }
+
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
-    return test_sampling();
+    RUN_TEST_CASE(test_sampling, "Walker alias sampling");
+    RUN_TEST_CASE(test_rbinom_state, "binomial sampling with explicit state");
+    return 0;
 }
@@ -0,0 +1,192 @@
+/* test_sort.c
+ *
+ * Copyright (C) 2026 Tamas Nepusz
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or (at
+ * your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <string.h>
+#include "plfit_error.h"
+#include "sort.h"
+
+#include "test_common.h"
+
+#define MAX_N 100000
+
+double xs[MAX_N];
+double expected[MAX_N];
+double observed[MAX_N];
+
+static int double_comparator(const void *a, const void *b) {
+    const double *da = (const double*)a;
+    const double *db = (const double*)b;
+    return (*da > *db) - (*da < *db);
+}
+
+/* Fills xs with one of several kinds of test data */
+static void fill_data(size_t n, int kind) {
+    size_t i;
+    unsigned long state = 12345 + kind;
+
+    for (i = 0; i < n; i++) {
+        state = state * 6364136223846793005UL + 1442695040888963407UL;
+        switch (kind) {
+            case 0:
+                /* continuous data with both signs */
+                xs[i] = ((state >> 11) / 9007199254740992.0 - 0.3) * 1e6;
+                break;
+
+            case 1:
+                /* integers with many ties */
+                xs[i] = (double)((state >> 33) % 50);
+                break;
+
+            case 2:
+                /* heavy-tailed data spanning many orders of magnitude */
+                xs[i] = 1.0 / ((state >> 11) / 9007199254740992.0 + 1e-300);
+                break;
+
+            case 3:
+                /* all equal */
+                xs[i] = 3.5;
+                break;
+
+            default:
+                /* decreasing sequence with zeros of both signs */
+                xs[i] = (i % 7 == 0) ? ((i % 2) ? -0.0 : 0.0) : (double)n - 2.0 * i;
+                break;
+        }
+    }
+}
+
+static int check_sorted(size_t n) {
+    size_t i;
+
+    memcpy(expected, xs, sizeof(double) * n);
+    qsort(expected, n, sizeof(double), double_comparator);
+
+    for (i = 0; i < n; i++) {
+        if (observed[i] != expected[i]) {
+            fprintf(stderr, "mismatch at index %ld: expected %g, got %g\n",
+                    (long)i, expected[i], observed[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int test_sort_methods() {
+    const size_t ns[] = { 0, 1, 2, 3, 16, 17, 100, 2047, 2048, 5000, MAX_N };
+    size_t i;
+    int kind;
+
+    for (i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        for (kind = 0; kind < 5; kind++) {
+            fill_data(ns[i], kind);
+
+            ASSERT_SUCCESSFUL(plfit_sort_doubles(xs, ns[i], observed, NULL));
+            ASSERT_ZERO(check_sorted(ns[i]));
+
+            ASSERT_SUCCESSFUL(plfit_radix_sort_doubles(xs, ns[i], observed, NULL));
+            ASSERT_ZERO(check_sorted(ns[i]));
+
+            memcpy(observed, xs, sizeof(double) * ns[i]);
+            plfit_introsort_doubles(observed, ns[i]);
+            ASSERT_ZERO(check_sorted(ns[i]));
+        }
+    }
+
+    return 0;
+}
+
+/* Checks the runs of the sorted array in observed[] against a naive scan */
+static int check_runs(size_t n, const plfit_sorted_runs_t* runs) {
+    size_t i, run = 0;
+
+    for (i = 0; i < n; i++) {
+        if (i == 0 || observed[i] != observed[i-1]) {
+            if (run >= runs->num_runs || plfit_sorted_runs_start(runs, run) != i) {
+                fprintf(stderr, "run #%ld should start at index %ld\n", (long)run, (long)i);
+                return 1;
+            }
+            run++;
+        }
+    }
+
+    if (run != runs->num_runs || plfit_sorted_runs_start(runs, run) != n) {
+        fprintf(stderr, "expected %ld runs, got %ld\n", (long)run, (long)runs->num_runs);
+        return 1;
+    }
+
+    return 0;
+}
+
+int test_sort_with_runs() {
+    const size_t ns[] = { 0, 1, 2, 100, 2048, 5000, MAX_N };
+    plfit_sorted_runs_t runs;
+    size_t i;
+    int kind;
+
+    for (i = 0; i < sizeof(ns) / sizeof(ns[0]); i++) {
+        for (kind = 0; kind < 5; kind++) {
+            fill_data(ns[i], kind);
+
+            ASSERT_SUCCESSFUL(plfit_sort_doubles(xs, ns[i], observed, &runs));
+            ASSERT_ZERO(check_sorted(ns[i]));
+            ASSERT_ZERO(check_runs(ns[i], &runs));
+            plfit_sorted_runs_destroy(&runs);
+
+            ASSERT_SUCCESSFUL(plfit_radix_sort_doubles(xs, ns[i], observed, &runs));
+            ASSERT_ZERO(check_sorted(ns[i]));
+            ASSERT_ZERO(check_runs(ns[i], &runs));
+            plfit_sorted_runs_destroy(&runs);
+        }
+    }
+
+    return 0;
+}
+
+int test_signed_zeros() {
+    double data[] = { 0.0, -0.0, 1.0, -0.0, -1.0, 0.0 };
+    double result[6];
+
+    /* Negative zeros precede positive zeros with both methods */
+    ASSERT_SUCCESSFUL(plfit_radix_sort_doubles(data, 6, result, NULL));
+    ASSERT_EQUAL(result[0], -1.0);
+    ASSERT_NONZERO(signbit(result[1]));
+    ASSERT_NONZERO(signbit(result[2]));
+    ASSERT_ZERO(signbit(result[3]));
+    ASSERT_ZERO(signbit(result[4]));
+    ASSERT_EQUAL(result[5], 1.0);
+
+    memcpy(result, data, sizeof(data));
+    plfit_introsort_doubles(result, 6);
+    ASSERT_EQUAL(result[0], -1.0);
+    ASSERT_NONZERO(signbit(result[1]));
+    ASSERT_NONZERO(signbit(result[2]));
+    ASSERT_ZERO(signbit(result[3]));
+    ASSERT_ZERO(signbit(result[4]));
+    ASSERT_EQUAL(result[5], 1.0);
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    RUN_TEST_CASE(test_sort_methods, "sorting methods agree with qsort()");
+    RUN_TEST_CASE(test_sort_with_runs, "sorting with run-length structure");
+    RUN_TEST_CASE(test_signed_zeros, "ordering of signed zeros");
+    return 0;
+}